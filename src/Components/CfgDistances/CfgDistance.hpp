@@ -30,6 +30,97 @@ namespace Antipatrea
         {
             return(Distance(cfg1,cfg2));
         }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Computes a value that increases with the distance between two configurations,
+         *       which is cheaper to compute than the distance itself.
+         *
+         *@remarks
+         * - Use it when the distance is only compared, e.g., against a threshold converted with
+         *   DistanceToComparable or against other comparable distances.
+         * - Comparable distances do not satisfy the triangle inequality, so they should not be
+         *   used for pruning in metric data structures.
+         * - The default implementation returns Distance(cfg1, cfg2).
+         */
+        virtual double ComparableDistance(const Cfg & cfg1, const Cfg & cfg2)
+        {
+            return Distance(cfg1, cfg2);
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Convert a distance into the corresponding comparable distance (see ComparableDistance).
+         */
+        virtual double DistanceToComparable(const double d) const
+        {
+            return d;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Convert a comparable distance (see ComparableDistance) into the corresponding distance.
+         */
+        virtual double ComparableToDistance(const double c) const
+        {
+            return c;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Computes a value <tt>b(cfg)</tt> such that <tt>|b(cfg1) - b(cfg2)| <= Distance(cfg1, cfg2)</tt>.
+         *
+         *@remarks
+         * - Metric data structures use it to discard configurations without computing the distance.
+         * - The default implementation returns 0, which gives no pruning.
+         */
+        virtual double LowerBoundKey(const Cfg &)
+        {
+            return 0.0;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Computes the distance between <tt>cfg</tt> and each of the configurations <tt>cfgs[0], ..., cfgs[n - 1]</tt>.
+         *
+         *@remarks
+         * - The distance to <tt>cfgs[i]</tt> is stored in <tt>dists[i]</tt>.
+         * - The default implementation calls Distance for each configuration. Distances
+         *   that benefit from scoring one configuration against many at once should override it.
+         */
+        virtual void Distances(const Cfg & cfg, const int n, const Cfg * const cfgs[], double dists[])
+        {
+            for(int i = 0; i < n; ++i)
+                dists[i] = Distance(cfg, *(cfgs[i]));
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Precompute and cache any data that speeds up subsequent distance computations
+         *       involving <tt>cfg</tt>.
+         *
+         *@remarks
+         * - Planners call this function once when <tt>cfg</tt> is stored in a planner vertex,
+         *   i.e., when its values no longer change.
+         * - The default implementation does nothing.
+         */
+        virtual void OnCfgStored(Cfg &)
+        {
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return true iff Distance, Distances, and LowerBoundKey can be called concurrently from several threads.
+         *
+         *@remarks
+         * - Planners use a single thread for the proximity data structure when it returns false.
+         * - The default implementation returns false. Distances that keep no mutable state (or keep it per thread)
+         *   should override it.
+         */
+        virtual bool IsThreadSafe(void) const
+        {
+            return false;
+        }
     };
 
     /**
@@ -1,21 +1,106 @@
 #include "Components/CfgDistances/CfgDistanceLp.hpp"
+#include "Components/CfgDistances/SignedDistanceBetweenTwoAngles.hpp"
+#include "Components/CfgDistances/SignedDistanceBetweenTwoNumbers.hpp"
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace Antipatrea
-{        
-    double CfgDistanceLp::Distance(const Cfg & cfg1, const Cfg & cfg2)
+{
+    template <int P, bool Angles>
+    double CfgDistanceLp::PowerSum(const double vals1[], const double vals2[], const int dim)
     {
-        const int     dim   = GetCfgManager()->GetDim();
-        const double *vals1 = cfg1.GetValues();
-        const double *vals2 = cfg2.GetValues();
-        double        s     = 0.0;
+        double s = 0.0;
 
         for(int i = 0; i < dim; ++i)
         {
-            const double d = fabs(GetSignedDistanceBetweenTwoValues()->SignedDistance(vals1[i], vals2[i]));
-            s += pow(d, m_exponent);
+            double d = fabs(vals2[i] - vals1[i]);
+
+            if(Angles)
+            {
+                // same as Algebra2D::AngleDistance
+                d -= 2 * M_PI * floor(d / (2 * M_PI));
+                d  = std::min(d, 2 * M_PI - d);
+            }
+
+            if(P == 1)
+                s += d;
+            else if(P == 2)
+                s += d * d;
+            else
+                s = std::max(s, d);
+        }
+
+        return s;
+    }
+
+    double CfgDistanceLp::PowerSumGeneric(const double vals1[], const double vals2[], const int dim)
+    {
+        auto   sdv = GetSignedDistanceBetweenTwoValues();
+        double s   = 0.0;
+
+        for(int i = 0; i < dim; ++i)
+        {
+            const double d = fabs(sdv->SignedDistance(vals1[i], vals2[i]));
+
+            if(m_exponent <= 0)
+                s = std::max(s, d);
+            else
+                s += pow(d, m_exponent);
+        }
+
+        return s;
+    }
+
+    void CfgDistanceLp::SelectKernel(void)
+    {
+        auto       sdv    = GetSignedDistanceBetweenTwoValues();
+        const bool angles = dynamic_cast<SignedDistanceBetweenTwoAngles*>(sdv) != NULL;
+
+        m_kernel = &CfgDistanceLp::PowerSumGeneric;
+        if(angles || dynamic_cast<SignedDistanceBetweenTwoNumbers*>(sdv) != NULL)
+        {
+            if(m_exponent == 1)
+                m_kernel = angles ? &CfgDistanceLp::PowerSum<1, true> : &CfgDistanceLp::PowerSum<1, false>;
+            else if(m_exponent == 2)
+                m_kernel = angles ? &CfgDistanceLp::PowerSum<2, true> : &CfgDistanceLp::PowerSum<2, false>;
+            else if(m_exponent <= 0)
+                m_kernel = angles ? &CfgDistanceLp::PowerSum<0, true> : &CfgDistanceLp::PowerSum<0, false>;
+        }
+    }
+
+    double CfgDistanceLp::DistanceToComparable(const double d) const
+    {
+        if(m_exponent == 1 || m_exponent <= 0)
+            return d;
+        else if(m_exponent == 2)
+            return d * d;
+        return pow(d, m_exponent);
+    }
+
+    double CfgDistanceLp::ComparableToDistance(const double c) const
+    {
+        if(m_exponent == 1 || m_exponent <= 0)
+            return c;
+        else if(m_exponent == 2)
+            return sqrt(c);
+        return pow(c, 1.0 / m_exponent);
+    }
+
+    void CfgDistanceLp::Distances(const Cfg & cfg, const int n, const Cfg * const cfgs[], double dists[])
+    {
+        const int     dim  = GetCfgManager()->GetDim();
+        const double *vals = cfg.GetValues();
+
+        // unpacked values are in a buffer that the other cfgs would reuse
+        std::vector<double> unpacked;
+        if(cfg.IsPacked())
+        {
+            unpacked.assign(vals, vals + dim);
+            vals = &unpacked[0];
         }
 
-        return pow(s, 1.0 / m_exponent);
+        for(int i = 0; i < n; ++i)
+            dists[i] = ComparableToDistance((this->*m_kernel)(vals, cfgs[i]->GetValues(), dim));
     }
 }
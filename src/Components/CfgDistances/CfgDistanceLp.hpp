@@ -20,6 +20,11 @@ namespace Antipatrea
      *    distance between any two values.
      *  - It also requires access to CfgManager to access the configuration dimension.
      *  - The user also needs to set the exponent p in the Lp norm.
+     *    An exponent less than or equal to zero denotes the L-infinity norm, i.e., <tt>max_{i} |a_{i}|</tt>.
+     *  - The loop over the values is selected when the exponent or the signed distance is set.
+     *    There are template-specialized loops for L1, L2, L-infinity over angles and over numbers
+     *    (SignedDistanceBetweenTwoAngles, SignedDistanceBetweenTwoNumbers). They do not make virtual
+     *    calls per value, so the compiler can vectorize them. Other combinations use a generic loop.
      */
 
     class CfgDistanceLp : public CfgDistance,
@@ -30,9 +35,10 @@ namespace Antipatrea
         CfgDistanceLp(void) : CfgDistance(),
                               CfgManagerContainer(),
                               SignedDistanceBetweenTwoValuesContainer(),
-                              m_exponent(Constants::VAL_CfgDistanceLp_Exponent)
-                                        
+                              m_exponent(Constants::VAL_CfgDistanceLp_Exponent),
+                              m_kernel(&CfgDistanceLp::PowerSumGeneric)
         {
+            SelectKernel();
         }
         
         virtual ~CfgDistanceLp(void)
@@ -93,6 +99,17 @@ namespace Antipatrea
         virtual void SetExponent(int exponent)
         {
             m_exponent = exponent;
+            SelectKernel();
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Set the signed distance between two values and select the matching distance loop.
+         */
+        virtual void SetSignedDistanceBetweenTwoValues(SignedDistanceBetweenTwoValues * const other)
+        {
+            SignedDistanceBetweenTwoValuesContainer::SetSignedDistanceBetweenTwoValues(other);
+            SelectKernel();
         }
         
         /**
@@ -104,11 +121,66 @@ namespace Antipatrea
          *    where <tt> a_{i} = GetSignedDistanceBetweenTwoValues()->SignedDistance(cfg1->GetValues()[i], cfg2->GetValues()[i])</tt>
          */
         virtual double Distance(const Cfg & cfg1,
-                                const Cfg & cfg2);
+                                const Cfg & cfg2)
+        {
+            return ComparableToDistance(ComparableDistance(cfg1, cfg2));
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Computes the sum of the p-th powers of <tt>|a_{i}|</tt> (or their maximum for L-infinity),
+         *       i.e., the distance without the final root.
+         */
+        virtual double ComparableDistance(const Cfg & cfg1,
+                                          const Cfg & cfg2)
+        {
+            return (this->*m_kernel)(cfg1.GetValues(), cfg2.GetValues(), GetCfgManager()->GetDim());
+        }
+
+        virtual double DistanceToComparable(const double d) const;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return true since the distance does not change any state (packed values are unpacked per thread).
+         */
+        virtual bool IsThreadSafe(void) const
+        {
+            return true;
+        }
+
+        virtual double ComparableToDistance(const double c) const;
 
+        virtual void Distances(const Cfg & cfg, const int n, const Cfg * const cfgs[], double dists[]);
 
     protected:
-        int m_exponent;
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Signature of the loops that compute the comparable distance between two value arrays.
+         */
+        typedef double (CfgDistanceLp::*Kernel)(const double vals1[], const double vals2[], const int dim);
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Select the loop that matches the exponent and the signed distance.
+         */
+        virtual void SelectKernel(void);
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Loop specialized at compile time for the exponent <tt>P</tt> (1, 2, or 0 for L-infinity)
+         *       and for angles or numbers.
+         */
+        template <int P, bool Angles>
+        double PowerSum(const double vals1[], const double vals2[], const int dim);
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Loop for any exponent and signed distance.
+         */
+        double PowerSumGeneric(const double vals1[], const double vals2[], const int dim);
+
+        int    m_exponent;
+        Kernel m_kernel;
     };
 
     /**
@@ -0,0 +1,204 @@
+#include "Components/CfgForwardKinematics/CfgForwardKinematicsBackbone.hpp"
+#include <cmath>
+#include <cstring>
+
+namespace Antipatrea
+{
+    CfgForwardKinematicsBackbone::CfgForwardKinematicsBackbone(void) : CfgForwardKinematics()
+    {
+        m_cosNCAC = cos(Constants::VAL_CfgForwardKinematicsBackbone_BondAngleNCAC);
+        m_sinNCAC = sin(Constants::VAL_CfgForwardKinematicsBackbone_BondAngleNCAC);
+        m_cosCACN = cos(Constants::VAL_CfgForwardKinematicsBackbone_BondAngleCACN);
+        m_sinCACN = sin(Constants::VAL_CfgForwardKinematicsBackbone_BondAngleCACN);
+        m_cosCNCA = cos(Constants::VAL_CfgForwardKinematicsBackbone_BondAngleCNCA);
+        m_sinCNCA = sin(Constants::VAL_CfgForwardKinematicsBackbone_BondAngleCNCA);
+    }
+
+    void CfgForwardKinematicsBackbone::DoFK(void)
+    {
+        m_coords.resize(3 * GetNrBackboneAtoms());
+        BuildBackbone(&m_joints[0], &m_coords[0]);
+    }
+
+    void CfgForwardKinematicsBackbone::GetBackboneCoords(const Cfg & cfg, double coords[])
+    {
+        BuildBackbone(cfg.GetValues(), coords);
+    }
+
+    void CfgForwardKinematicsBackbone::PlaceAtom(const double a[], const double b[], const double c[],
+                                                 const double len,
+                                                 const double cosAngle, const double sinAngle,
+                                                 const double cosTorsion, const double sinTorsion,
+                                                 double d[])
+    {
+        // local frame at c: bc along the last bond, n normal to the abc plane, m = n x bc
+        double bc[3] = {c[0] - b[0], c[1] - b[1], c[2] - b[2]};
+        double ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        double s     = 1.0 / sqrt(bc[0] * bc[0] + bc[1] * bc[1] + bc[2] * bc[2]);
+
+        bc[0] *= s; bc[1] *= s; bc[2] *= s;
+
+        double n[3] = {ab[1] * bc[2] - ab[2] * bc[1],
+                       ab[2] * bc[0] - ab[0] * bc[2],
+                       ab[0] * bc[1] - ab[1] * bc[0]};
+
+        s = 1.0 / sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        n[0] *= s; n[1] *= s; n[2] *= s;
+
+        const double m[3] = {n[1] * bc[2] - n[2] * bc[1],
+                             n[2] * bc[0] - n[0] * bc[2],
+                             n[0] * bc[1] - n[1] * bc[0]};
+
+        // position of d in the local frame
+        const double dx = -len * cosAngle;
+        const double dy =  len * sinAngle * cosTorsion;
+        const double dz =  len * sinAngle * sinTorsion;
+
+        d[0] = c[0] + dx * bc[0] + dy * m[0] + dz * n[0];
+        d[1] = c[1] + dx * bc[1] + dy * m[1] + dz * n[1];
+        d[2] = c[2] + dx * bc[2] + dy * m[2] + dz * n[2];
+    }
+
+    void CfgForwardKinematicsBackbone::Frame(const double a[], const double b[], const double c[], double F[])
+    {
+        // same frame as in PlaceAtom: rows are bc, n x bc, n
+        double *u = F;
+        double *m = F + 3;
+        double *n = F + 6;
+        double  ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+        double  s;
+
+        u[0] = c[0] - b[0]; u[1] = c[1] - b[1]; u[2] = c[2] - b[2];
+        s    = 1.0 / sqrt(u[0] * u[0] + u[1] * u[1] + u[2] * u[2]);
+        u[0] *= s; u[1] *= s; u[2] *= s;
+
+        n[0] = ab[1] * u[2] - ab[2] * u[1];
+        n[1] = ab[2] * u[0] - ab[0] * u[2];
+        n[2] = ab[0] * u[1] - ab[1] * u[0];
+        s    = 1.0 / sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        n[0] *= s; n[1] *= s; n[2] *= s;
+
+        m[0] = n[1] * u[2] - n[2] * u[1];
+        m[1] = n[2] * u[0] - n[0] * u[2];
+        m[2] = n[0] * u[1] - n[1] * u[0];
+    }
+
+    CfgForwardKinematicsBackbone::Trig& CfgForwardKinematicsBackbone::ComputeTrig(const double vals[], const int from, const int to) const
+    {
+        static thread_local Trig trig;
+
+        trig.m_cos.resize(3 * GetNrResidues());
+        trig.m_sin.resize(3 * GetNrResidues());
+
+        double *cosines = &trig.m_cos[0];
+        double *sines   = &trig.m_sin[0];
+
+        // trig for the dihedrals in one vectorizable pass
+        for(int i = from; i < to; ++i)
+        {
+            cosines[i] = cos(vals[i]);
+            sines[i]   = sin(vals[i]);
+        }
+
+        return trig;
+    }
+
+    void CfgForwardKinematicsBackbone::BuildBackbone(const double vals[], double coords[])
+    {
+        const int nres = GetNrResidues();
+
+        if(nres <= 0)
+            return;
+
+        const Trig & trig = ComputeTrig(vals, 0, 3 * nres);
+
+        const double lenNCA = Constants::VAL_CfgForwardKinematicsBackbone_BondLengthNCA;
+        const double lenCAC = Constants::VAL_CfgForwardKinematicsBackbone_BondLengthCAC;
+
+        // first residue: N at the origin, CA along x, C in the xy-plane
+        coords[0] = 0.0;
+        coords[1] = 0.0;
+        coords[2] = 0.0;
+        coords[3] = lenNCA;
+        coords[4] = 0.0;
+        coords[5] = 0.0;
+        coords[6] = lenNCA - lenCAC * m_cosNCAC;
+        coords[7] = lenCAC * m_sinNCAC;
+        coords[8] = 0.0;
+
+        // residue i is placed from the N, CA, C of residue i - 1:
+        //  N(i)  uses psi(i - 1), CA(i) uses omega(i - 1), C(i) uses phi(i)
+        for(int i = 1; i < nres; ++i)
+            PlaceResidue(trig, i, coords);
+    }
+
+    void CfgForwardKinematicsBackbone::UpdateBackboneCoords(const double vals[],
+                                                            const int start,
+                                                            const int end,
+                                                            const double parentCoords[],
+                                                            double coords[])
+    {
+        const int nres = GetNrResidues();
+
+        // residue 0 is fixed, so its dihedrals do not move any atom; otherwise,
+        // phi(start) moves C(start) and everything after it
+        const int first = start < 1 ? 1 : start;
+        const int last  = end < nres ? end : nres - 1;
+
+        if(nres <= 1 || first > last)
+        {
+            memcpy(coords, parentCoords, 9 * nres * sizeof(double));
+            return;
+        }
+
+        const Trig & trig = ComputeTrig(vals, 3 * first - 2, 3 * last + 1);
+
+        if(start >= 1)
+        {
+            memcpy(coords, parentCoords, (9 * first + 6) * sizeof(double));
+            PlaceC(trig, first, coords);
+        }
+        else
+        {
+            memcpy(coords, parentCoords, 9 * first * sizeof(double));
+            PlaceResidue(trig, first, coords);
+        }
+        for(int i = first + 1; i <= last; ++i)
+            PlaceResidue(trig, i, coords);
+
+        if(last == nres - 1)
+            return;
+
+        // the rest of the chain moves rigidly with the N, CA, C of residue last:
+        // x' = newC + R (x - oldC), where R = Fnew^T Fold
+        const double *oldAtoms = &parentCoords[9 * last];
+        const double *newAtoms = &coords[9 * last];
+        double        Fold[9];
+        double        Fnew[9];
+        double        R[9];
+
+        Frame(oldAtoms, oldAtoms + 3, oldAtoms + 6, Fold);
+        Frame(newAtoms, newAtoms + 3, newAtoms + 6, Fnew);
+        for(int i = 0; i < 3; ++i)
+            for(int j = 0; j < 3; ++j)
+                R[3 * i + j] = Fnew[i] * Fold[j] + Fnew[3 + i] * Fold[3 + j] + Fnew[6 + i] * Fold[6 + j];
+
+        const double ox = oldAtoms[6];
+        const double oy = oldAtoms[7];
+        const double oz = oldAtoms[8];
+        const double nx = newAtoms[6];
+        const double ny = newAtoms[7];
+        const double nz = newAtoms[8];
+
+        for(int i = 9 * (last + 1); i < 9 * nres; i += 3)
+        {
+            const double x = parentCoords[i]     - ox;
+            const double y = parentCoords[i + 1] - oy;
+            const double z = parentCoords[i + 2] - oz;
+
+            coords[i]     = nx + R[0] * x + R[1] * y + R[2] * z;
+            coords[i + 1] = ny + R[3] * x + R[4] * y + R[5] * z;
+            coords[i + 2] = nz + R[6] * x + R[7] * y + R[8] * z;
+        }
+    }
+}
@@ -0,0 +1,233 @@
+#ifndef Antipatrea__CfgForwardKinematicsBackbone_HPP_
+#define Antipatrea__CfgForwardKinematicsBackbone_HPP_
+
+#include "Components/CfgForwardKinematics/CfgForwardKinematics.hpp"
+#include "Setup/Defaults.hpp"
+#include <vector>
+
+namespace Antipatrea
+{
+    /**
+     *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+     *@brief Forward kinematics for a protein backbone computed directly from the
+     *       dihedral angles, without going through a Rosetta pose.
+     *
+     *@remarks
+     * - The configuration values are interpreted as phi, psi, omega (in radians) for each residue,
+     *   i.e., <tt>vals[3 * i]</tt>, <tt>vals[3 * i + 1]</tt>, <tt>vals[3 * i + 2]</tt> for residue <tt>i</tt>,
+     *   which is the same layout used by MolecularStructureRosetta.
+     * - The N, CA, C atoms of each residue are placed one after the other with the
+     *   Natural Extension Reference Frame (NeRF) method using ideal bond lengths and angles
+     *   (see Constants::VAL_CfgForwardKinematicsBackbone_*).
+     * - The sines/cosines of all the dihedral angles are computed in a separate pass over
+     *   contiguous arrays so that the compiler can vectorize it; the sequential placement
+     *   then only does multiplications and additions.
+     * - The coordinates are stored in a flat array as x0 y0 z0 x1 y1 z1 ...,
+     *   with atoms ordered N, CA, C for residue 0, then residue 1, and so on.
+     * - This class requires access to CfgManager to get the configuration dimension,
+     *   which should be three times the number of residues.
+     * - Only the forward kinematics is free of Rosetta. CfgDistanceAtomRMSD and the DeltaR/USR
+     *   projections that use these coordinates still live in PluginRosetta and reach them through
+     *   MolecularStructureRosetta (option NativeBackboneFK), so a build without Rosetta cannot use them yet.
+     */
+    class CfgForwardKinematicsBackbone : public CfgForwardKinematics
+    {
+    public:
+        CfgForwardKinematicsBackbone(void);
+
+        virtual ~CfgForwardKinematicsBackbone(void)
+        {
+        }
+
+        virtual bool CheckSetup(void) const
+        {
+            return
+                CfgForwardKinematics::CheckSetup() &&
+                GetCfgManager() != NULL &&
+                GetCfgManager()->CheckSetup() &&
+                GetCfgManager()->GetDim() % 3 == 0;
+        }
+
+        virtual void Info(const char prefix[]) const
+        {
+            CfgForwardKinematics::Info(prefix);
+            Logger::m_out << prefix << " CfgManager = " << Name(GetCfgManager()) << std::endl
+                          << prefix << " NrResidues = " << GetNrResidues() << std::endl;
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Return the number of residues, i.e., one third of the configuration dimension.
+         */
+        virtual int GetNrResidues(void) const
+        {
+            return GetCfgManager()->GetDim() / 3;
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Return the number of backbone atoms (N-CA-C per residue).
+         */
+        virtual int GetNrBackboneAtoms(void) const
+        {
+            return 3 * GetNrResidues();
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Get the backbone coordinates computed by the last call to FK.
+         */
+        virtual const double* GetCoords(void) const
+        {
+            return &m_coords[0];
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Write the backbone coordinates of the configuration into <tt>coords</tt>.
+         *
+         *@remarks
+         * - <tt>coords</tt> should have room for 3 * GetNrBackboneAtoms() values.
+         * - It does not change the joint values or coordinates stored in this object.
+         */
+        virtual void GetBackboneCoords(const Cfg & cfg, double coords[]);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Write the backbone coordinates of the configuration into <tt>coords</tt>, given the
+         *       backbone coordinates <tt>parentCoords</tt> of a configuration that differs from it only in
+         *       the dihedral angles of residues <tt>start</tt>, ..., <tt>end - 1</tt>.
+         *
+         *@remarks
+         * - The atoms before the changed segment are copied from <tt>parentCoords</tt> and only the atoms
+         *   of the changed segment are placed again. Since the dihedral angles after the segment are the same,
+         *   the rest of the chain is obtained by applying to <tt>parentCoords</tt> the rigid-body transformation
+         *   that maps the old N, CA, C of the last rebuilt residue onto the new ones.
+         * - The result is the same as GetBackboneCoords(cfg, coords) up to round-off, at a fraction of the cost
+         *   when the segment is short, e.g., when generating offspring by fragment replacement.
+         * - <tt>parentCoords</tt> and <tt>coords</tt> should not overlap.
+         */
+        virtual void UpdateBackboneCoords(const Cfg & cfg,
+                                          const int start,
+                                          const int end,
+                                          const double parentCoords[],
+                                          double coords[])
+        {
+            UpdateBackboneCoords(cfg.GetValues(), start, end, parentCoords, coords);
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Same as UpdateBackboneCoords(cfg, start, end, parentCoords, coords), but the
+         *       dihedral angles are given directly by <tt>vals</tt>.
+         */
+        virtual void UpdateBackboneCoords(const double vals[],
+                                          const int start,
+                                          const int end,
+                                          const double parentCoords[],
+                                          double coords[]);
+
+    protected:
+        virtual void DoFK(void);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Place the backbone atoms from the dihedral angles <tt>vals</tt>.
+         */
+        virtual void BuildBackbone(const double vals[], double coords[]);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Cosines/sines of the dihedral angles.
+         */
+        struct Trig
+        {
+            std::vector<double> m_cos;
+            std::vector<double> m_sin;
+        };
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Compute the cosines/sines of the dihedral angles <tt>vals[from]</tt>, ..., <tt>vals[to - 1]</tt>.
+         *
+         *@remarks
+         * - They are stored in a per-thread Trig, which is returned, so that
+         *   GetBackboneCoords and UpdateBackboneCoords can be called concurrently.
+         */
+        virtual Trig& ComputeTrig(const double vals[], const int from, const int to) const;
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Place the N, CA, C atoms of residue <tt>i</tt> (<tt>i</tt> > 0) from those of residue <tt>i - 1</tt>.
+         *
+         *@remarks
+         * - The cosines/sines of the dihedral angles should have already been computed by ComputeTrig.
+         */
+        void PlaceResidue(const Trig & trig, const int i, double coords[]) const
+        {
+            const double *prev = &coords[9 * (i - 1)];
+            double       *curr = &coords[9 * i];
+
+            PlaceAtom(prev, prev + 3, prev + 6, Constants::VAL_CfgForwardKinematicsBackbone_BondLengthCN,
+                      m_cosCACN, m_sinCACN, trig.m_cos[3 * i - 2], trig.m_sin[3 * i - 2], curr);
+            PlaceAtom(prev + 3, prev + 6, curr, Constants::VAL_CfgForwardKinematicsBackbone_BondLengthNCA,
+                      m_cosCNCA, m_sinCNCA, trig.m_cos[3 * i - 1], trig.m_sin[3 * i - 1], curr + 3);
+            PlaceC(trig, i, coords);
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Place the C atom of residue <tt>i</tt> (<tt>i</tt> > 0) from its N, CA and the C of residue <tt>i - 1</tt>.
+         */
+        void PlaceC(const Trig & trig, const int i, double coords[]) const
+        {
+            const double *curr = &coords[9 * i];
+
+            PlaceAtom(curr - 3, curr, curr + 3, Constants::VAL_CfgForwardKinematicsBackbone_BondLengthCAC,
+                      m_cosNCAC, m_sinNCAC, trig.m_cos[3 * i], trig.m_sin[3 * i], &coords[9 * i + 6]);
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Compute the orthonormal frame (stored row-wise in <tt>F</tt>) defined by the atoms <tt>a</tt>, <tt>b</tt>, <tt>c</tt>.
+         */
+        static void Frame(const double a[], const double b[], const double c[], double F[]);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Place atom <tt>d</tt> given the three preceding atoms <tt>a</tt>, <tt>b</tt>, <tt>c</tt>,
+         *       the bond length |cd| = <tt>len</tt>, the bond angle bcd (as its cosine and sine), and
+         *       the dihedral angle abcd (as its cosine and sine).
+         */
+        static void PlaceAtom(const double a[], const double b[], const double c[],
+                              const double len,
+                              const double cosAngle, const double sinAngle,
+                              const double cosTorsion, const double sinTorsion,
+                              double d[]);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Backbone coordinates computed by DoFK.
+         */
+        std::vector<double> m_coords;
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Cosines/sines of the ideal bond angles.
+         */
+        double m_cosNCAC;
+        double m_sinNCAC;
+        double m_cosCACN;
+        double m_sinCACN;
+        double m_cosCNCA;
+        double m_sinCNCA;
+    };
+
+    /**
+     *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+     *@brief Get/set methods for components that need access to CfgForwardKinematicsBackbone.
+     */
+    ClassContainer(CfgForwardKinematicsBackbone, m_cfgForwardKinematicsBackbone);
+}
+
+#endif
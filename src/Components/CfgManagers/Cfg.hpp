@@ -1,6 +1,7 @@
 #ifndef Antipatrea__Cfg_HPP_
 #define Antipatrea__Cfg_HPP_
 
+#include <cassert>
 #include <cstdlib>
 
 namespace Antipatrea
@@ -25,6 +26,8 @@ namespace Antipatrea
      *   set the allocator for the planner/component to an instance of MyCfgManager, and then write inside the planner/component
      *   <tt>Cfg *cfg = GetCfgManager()->NewCfg() </tt>.
      */
+    class CfgManager;
+
     class Cfg
     {
     public:
@@ -37,8 +40,12 @@ namespace Antipatrea
 
         virtual ~Cfg(void)
         {
-                if(m_values)
+                if(m_values && m_poolId < 0)
                         delete [] m_values;
+                if(m_packed)
+                        delete [] m_packed;
+                if(m_coords)
+                        delete [] m_coords;
         }
 
         /**
@@ -48,10 +55,14 @@ namespace Antipatrea
          *@remarks
          * - Function returns just the pointer, not a deep copy.
          * - The values are allocated by CfgManager.
+         * - If the values have been packed (see CfgManager::StoreCfg), they are unpacked into a
+         *   per-thread buffer, which is reused after Constants::VAL_CfgManager_NrUnpackBuffers other unpacks.
+         *   The pointer should then be used right away and not kept; CfgManager::GetValues unpacks
+         *   into a buffer provided by the caller.
          */
         virtual const double* GetValues(void) const
         {
-                return m_values;
+                return m_values ? m_values : UnpackValues();
         }
 
 
@@ -62,12 +73,25 @@ namespace Antipatrea
          *@remarks
          * - Function returns just the pointer; not a deep copy.
          * - The values are allocated by CfgManager.
+         * - It should not be called if the values have been packed (see CfgManager::StoreCfg),
+         *   since changes through the pointer would not be kept. Use the const version to read
+         *   packed values and SetValues or CfgManager::CopyCfg to change them.
          */
         virtual double* GetValues(void)
         {
+            assert(m_packed == NULL);
             return m_values;
         }
 
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return true iff the values have been packed by CfgManager::StoreCfg.
+         */
+        virtual bool IsPacked(void) const
+        {
+            return m_packed != NULL;
+        }
+
         
         /**
          *@author Erion Plaku, Amarda Shehu
@@ -78,11 +102,55 @@ namespace Antipatrea
          * - The values are allocated by CfgManager.
          * - The energy field is marked as undefined to indicate
          *   that the energy should be computed (since the values changed).
+         * - If the values have been packed, <tt>values</tt> are packed again instead,
+         *   so that changes to the unpacked values are kept.
          */
         virtual void SetValues(double * const values)
         {
-            m_values = values;
+            if(m_packed && values)
+                RepackValues(values);
+            else
+                m_values = values;
             SetEnergy(ENERGY_UNDEFINED);
+            ClearCoords();
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Get pointer to the cached coordinates (NULL if none are cached).
+         *
+         *@remarks
+         * - The coordinates are computed once by CfgDistance::OnCfgStored when the
+         *   configuration is stored in a planner vertex, i.e., when its values no longer change.
+         * - Their layout and size are determined by the CfgDistance that computed them.
+         */
+        virtual const double* GetCoords(void) const
+        {
+            return m_coords;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Set pointer to the cached coordinates.
+         *
+         *@remarks
+         * - The configuration takes ownership of <tt>coords</tt> (allocated with <tt>new[]</tt>)
+         *   and deletes any previously cached coordinates.
+         */
+        virtual void SetCoords(double * const coords)
+        {
+            if(m_coords && m_coords != coords)
+                delete[] m_coords;
+            m_coords = coords;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Delete the cached coordinates, e.g., since the values changed.
+         */
+        virtual void ClearCoords(void)
+        {
+            SetCoords(NULL);
         }
 
         /**
@@ -115,6 +183,15 @@ namespace Antipatrea
         {
             return GetEnergy() != ENERGY_UNDEFINED;
         }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Get the id of the slot where CfgManager stores the values (negative if the values are not pooled).
+         */
+        virtual int GetPoolId(void) const
+        {
+            return m_poolId;
+        }
         
         protected:
             /**
@@ -122,7 +199,11 @@ namespace Antipatrea
              *@brief Constructor is made protected since new configurations should be allocated only via CfgManager.
              */
             Cfg(void) : m_values(NULL),
-                        m_energy(ENERGY_UNDEFINED)
+                        m_energy(ENERGY_UNDEFINED),
+                        m_coords(NULL),
+                        m_poolId(-1),
+                        m_packed(NULL),
+                        m_packedBy(NULL)
             {
             }
 
@@ -150,6 +231,45 @@ namespace Antipatrea
              */
             double  m_energy;
 
+            /**
+             *@author Erion Plaku, Amarda Shehu
+             *@brief Cached coordinates (NULL if none are cached).
+             */
+            double *m_coords;
+
+            /**
+             *@author Erion Plaku, Amarda Shehu
+             *@brief Id of the slot where CfgManager stores the values (negative if the values are not pooled).
+             *
+             *@remarks
+             * - Pooled values belong to CfgManager, so they are not deleted with the configuration.
+             */
+            int     m_poolId;
+
+            /**
+             *@author Erion Plaku, Amarda Shehu
+             *@brief Unpack the values into a per-thread buffer (see CfgManager::UnpackValues).
+             */
+            double* UnpackValues(void) const;
+
+            /**
+             *@author Erion Plaku, Amarda Shehu
+             *@brief Pack the values again (see CfgManager::PackValues).
+             */
+            void RepackValues(const double values[]);
+
+            /**
+             *@author Erion Plaku, Amarda Shehu
+             *@brief Packed values (NULL if the values are not packed).
+             */
+            unsigned char *m_packed;
+
+            /**
+             *@author Erion Plaku, Amarda Shehu
+             *@brief CfgManager that packed the values.
+             */
+            const CfgManager *m_packedBy;
+
             /**
              *@author Erion Plaku, Amarda Shehu
              *@brief CfgManager performs allocate/copy functions for configurations.
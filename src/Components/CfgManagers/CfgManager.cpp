@@ -1,11 +1,171 @@
 #include "Components/CfgManagers/CfgManager.hpp"
 #include "Utils/Reader.hpp"
+#include "Utils/Algebra2D.hpp"
 #include <cmath>
+#include <cstdint>
 
 namespace Antipatrea
 {
     double Cfg::ENERGY_UNDEFINED = INFINITY;
 
+    double* Cfg::UnpackValues(void) const
+    {
+        if(m_packed == NULL)
+            return NULL;
+
+        static thread_local std::vector<double> buffers[Constants::VAL_CfgManager_NrUnpackBuffers];
+        static thread_local int                 next = 0;
+
+        std::vector<double> &buffer = buffers[next];
+
+        next = (next + 1) % Constants::VAL_CfgManager_NrUnpackBuffers;
+        buffer.resize(m_packedBy->GetDim());
+        m_packedBy->UnpackValues(*this, &buffer[0]);
+
+        return &buffer[0];
+    }
+
+    void Cfg::RepackValues(const double values[])
+    {
+        m_packedBy->PackValues(*this, values);
+    }
+
+    CfgManager::~CfgManager(void)
+    {
+        for(int i = 0; i < (int) m_freeCfgs.size(); ++i)
+            delete m_freeCfgs[i];
+        for(int i = 0; i < (int) m_chunks.size(); ++i)
+            delete[] m_chunks[i].m_memory;
+    }
+
+    Cfg* CfgManager::NewCfg(void) const
+    {
+        std::lock_guard<std::mutex> guard(m_poolMutex);
+        Cfg                        *cfg;
+
+        if(!m_freeCfgs.empty())
+        {
+            cfg = m_freeCfgs.back();
+            m_freeCfgs.pop_back();
+            cfg->SetValues(cfg->m_values);
+            return cfg;
+        }
+
+        if(!m_freeSlots.empty())
+        {
+            cfg           = new Cfg();
+            cfg->m_poolId = m_freeSlots.back();
+            cfg->SetValues(SlotValues(cfg->m_poolId));
+            m_freeSlots.pop_back();
+            return cfg;
+        }
+
+        if(m_nrPooledCfgs == (int) m_chunks.size() * m_nrCfgsPerChunk)
+        {
+            const int align = Constants::VAL_CfgManager_ValuesAlignment;
+            Chunk     chunk;
+
+            if(m_chunks.empty())
+                m_stride = align * ((GetDim() + align - 1) / align);
+
+            chunk.m_memory = new double[m_nrCfgsPerChunk * m_stride + align];
+            chunk.m_values = chunk.m_memory;
+            while(((size_t) chunk.m_values) % (align * sizeof(double)) != 0)
+                ++chunk.m_values;
+            m_chunks.push_back(chunk);
+        }
+
+        cfg           = new Cfg();
+        cfg->m_poolId = m_nrPooledCfgs;
+        cfg->SetValues(m_chunks.back().m_values + (m_nrPooledCfgs % m_nrCfgsPerChunk) * m_stride);
+        ++m_nrPooledCfgs;
+
+        return cfg;
+    }
+
+    void CfgManager::DeleteCfg(Cfg * cfg)
+    {
+        if(cfg == NULL)
+            return;
+
+        std::lock_guard<std::mutex> guard(m_poolMutex);
+
+        if(IsPooled(*cfg))
+        {
+            cfg->ClearCoords();
+            m_freeCfgs.push_back(cfg);
+        }
+        else
+            delete cfg;
+    }
+
+    void CfgManager::StoreCfg(Cfg & cfg)
+    {
+        if(GetStorage() == STORAGE_DOUBLE || cfg.IsPacked() || cfg.m_values == NULL)
+            return;
+
+        const int n = GetDim();
+
+        cfg.m_packed   = new unsigned char[n * (GetStorage() == STORAGE_FLOAT ? sizeof(float) : sizeof(uint16_t))];
+        cfg.m_packedBy = this;
+        PackValues(cfg, cfg.m_values);
+
+        {
+            std::lock_guard<std::mutex> guard(m_poolMutex);
+
+            if(IsPooled(cfg))
+                m_freeSlots.push_back(cfg.m_poolId);
+            else
+                delete[] cfg.m_values;
+        }
+
+        cfg.m_values = NULL;
+        cfg.m_poolId = -1;
+    }
+
+    void CfgManager::PackValues(Cfg & cfg, const double vals[]) const
+    {
+        const int n = GetDim();
+
+        if(GetStorage() == STORAGE_FLOAT)
+        {
+            float *packed = (float *) cfg.m_packed;
+
+            for(int i = 0; i < n; ++i)
+                packed[i] = (float) vals[i];
+        }
+        else
+        {
+            // angles in [-pi, pi) are mapped to 0, ..., 2^16 - 1
+            const double scale  = 65536 / (2 * M_PI);
+            uint16_t    *packed = (uint16_t *) cfg.m_packed;
+
+            for(int i = 0; i < n; ++i)
+                packed[i] = (uint16_t) (((long) floor((Algebra2D::AngleNormalize(vals[i], -M_PI) + M_PI) * scale + 0.5)) & 0xFFFF);
+        }
+    }
+
+    void CfgManager::UnpackValues(const Cfg & cfg, double vals[]) const
+    {
+        const int n = GetDim();
+
+        if(GetStorage() == STORAGE_FLOAT)
+        {
+            const float *packed = (const float *) cfg.m_packed;
+
+            for(int i = 0; i < n; ++i)
+                vals[i] = packed[i];
+        }
+        else
+        {
+            const double    scale  = (2 * M_PI) / 65536;
+            const uint16_t *packed = (const uint16_t *) cfg.m_packed;
+
+            for(int i = 0; i < n; ++i)
+                vals[i] = packed[i] * scale - M_PI;
+        }
+    }
+
     std::ostream& CfgManager::PrintCfg(std::ostream & out, const Cfg & cfg) const
     {        
         const int     n    = GetDim();
@@ -21,9 +181,10 @@ namespace Antipatrea
 
     std::istream& CfgManager::ReadCfg(std::istream & in, Cfg & cfg) const
     {
-        const int n    = GetDim();
-        double   *vals = cfg.GetValues();
-        double    energy;
+        const int           n    = GetDim();
+        std::vector<double> unpacked(cfg.IsPacked() ? n : 0);
+        double             *vals = cfg.IsPacked() ? &unpacked[0] : cfg.GetValues();
+        double              energy;
         
         for(int i = 0; i < n; ++i)
         {
@@ -41,7 +202,14 @@ namespace Antipatrea
             return in;
         }
         
-        cfg.SetValues(vals);
+        if(cfg.IsPacked())
+        {
+            PackValues(cfg, vals);
+            cfg.SetEnergy(Cfg::ENERGY_UNDEFINED);
+            cfg.ClearCoords();
+        }
+        else
+            cfg.SetValues(vals);
         if(energy == INFINITY)
             cfg.SetEnergy(Cfg::ENERGY_UNDEFINED);
         else
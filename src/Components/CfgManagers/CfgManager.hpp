@@ -5,9 +5,12 @@
 #include "Components/CfgManagers/Cfg.hpp"
 #include "Setup/Defaults.hpp"
 #include "Utils/Allocator.hpp"
+#include "Utils/Misc.hpp"
 #include <cstdlib>
 #include <ostream>
 #include <istream>
+#include <vector>
+#include <mutex>
 
 namespace Antipatrea
 {
@@ -24,19 +27,34 @@ namespace Antipatrea
      *   planning purposes. By using CfgManager, such issue is avoided since one would write a class <tt>class MyCfgManager : public CfgManager</tt>,
      *   set the allocator for the planner/component to an instance of MyCfgManager, and then write inside the planner/component
      *   <tt>Cfg *cfg = GetCfgManager()->NewCfg() </tt>.
+     * - The configuration values are stored in large chunks, each holding the values of GetNrCfgsPerChunk() configurations
+     *   with a stride that is a multiple of Constants::VAL_CfgManager_ValuesAlignment doubles. The values of the configuration
+     *   with pool id <tt>id</tt> are at GetPooledValues(id), so configurations created one after the other are close in memory.
+     * - DeleteCfg does not free the memory. It puts the configuration (with its values) in a free list, and NewCfg reuses it.
+     *   This keeps allocations off the hot loops that create and discard many scratch configurations.
+     * - A pooled configuration can still be deleted with <tt>delete</tt> (e.g., by PlannerVertex). Its values are not freed, and
+     *   its slot is not reused until the manager is destroyed, which frees all the chunks. For this reason, the manager should outlive
+     *   the configurations it creates. The dimension should be set before any configuration is created.
+     * - NewCfg/DeleteCfg can be called from several threads.
+     * - Configurations that are stored for the rest of the run (planner vertices, edge intermediate configurations) are passed to
+     *   StoreCfg. When the storage is STORAGE_FLOAT or STORAGE_ANGLE16, StoreCfg packs their values as 32-bit floats or 16-bit angles,
+     *   and their slot is reused by NewCfg. The values are unpacked on demand by Cfg::GetValues, so distances, printing, and reading
+     *   work as before, while scratch configurations stay in double precision.
      */
     class CfgManager : public Component,
                        public Allocator
     {
     public:
         CfgManager(const int dim = 0) :  Component(),
-                                         Allocator(dim)
+                                         Allocator(dim),
+                                         m_nrCfgsPerChunk(Constants::VAL_CfgManager_NrCfgsPerChunk),
+                                         m_storage(STORAGE_DOUBLE),
+                                         m_stride(0),
+                                         m_nrPooledCfgs(0)
         {
         }
         
-        virtual ~CfgManager(void)
-        {
-        }
+        virtual ~CfgManager(void);
 
         virtual bool CheckSetup(void) const
         {
@@ -49,6 +67,8 @@ namespace Antipatrea
         {
             Component::Info(prefix);
             Logger::m_out << prefix << " Dim = " << GetDim() << std::endl
+                          << prefix << " NrCfgsPerChunk = " << GetNrCfgsPerChunk() << std::endl
+                          << prefix << " CfgStorage = " << GetStorage() << std::endl
                           << prefix << " Cfg::EnergyUndefined = " << Cfg::ENERGY_UNDEFINED << std::endl;
         }
 
@@ -58,7 +78,10 @@ namespace Antipatrea
          * 
          *@remarks
          * - Function first invokes Component::SetupFromParams(params).
-               * - It then sets the configuration dimension (keyword Constants::KW_Dim).
+         * - It then sets the configuration dimension (keyword Constants::KW_Dim)
+         *   and the number of configurations per chunk of values (keyword Constants::KW_NrCfgsPerChunk).
+         * - It also sets how stored configurations are kept (keyword Constants::KW_CfgStorage, with values
+         *   Constants::VAL_CfgManager_StorageDouble, Constants::VAL_CfgManager_StorageFloat, Constants::VAL_CfgManager_StorageAngle16).
          * - It uses the parameter group associated with the keyword Constants::KW_CfgManager.
          * - The parameter value can be specified in a text file as, for example,
          *     <center><tt>CfgManager { Dim 2 }</tt></center>
@@ -69,30 +92,153 @@ namespace Antipatrea
 
             auto data = params.GetData(Constants::KW_CfgManager);
             if(data && data->m_params)
+            {
                 SetDim(data->m_params->GetValueAsInt(Constants::KW_Dim, GetDim()));
+                SetNrCfgsPerChunk(data->m_params->GetValueAsInt(Constants::KW_NrCfgsPerChunk, GetNrCfgsPerChunk()));
+
+                auto storage = data->m_params->GetValue(Constants::KW_CfgStorage);
+                if(StrSameContent(storage, Constants::VAL_CfgManager_StorageFloat))
+                    SetStorage(STORAGE_FLOAT);
+                else if(StrSameContent(storage, Constants::VAL_CfgManager_StorageAngle16))
+                    SetStorage(STORAGE_ANGLE16);
+                else if(StrSameContent(storage, Constants::VAL_CfgManager_StorageDouble))
+                    SetStorage(STORAGE_DOUBLE);
+            }
         }
-        
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief How StoreCfg keeps the values of stored configurations.
+         *
+         *@remarks
+         * - STORAGE_DOUBLE: the values are not changed.
+         * - STORAGE_FLOAT: the values are packed as 32-bit floats.
+         * - STORAGE_ANGLE16: the values are interpreted as angles (in radians) and packed as 16-bit integers,
+         *   so the angular error is at most pi / 2^16. An unpacked angle is in <tt>[-pi, pi)</tt>.
+         */
+        enum Storage
+            {
+                STORAGE_DOUBLE,
+                STORAGE_FLOAT,
+                STORAGE_ANGLE16
+            };
+
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Create a new configuration and allocate memory for the configuration values.
+         *@brief Get how StoreCfg keeps the values of stored configurations.
+         */
+        virtual Storage GetStorage(void) const
+        {
+            return m_storage;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Set how StoreCfg keeps the values of stored configurations.
+         */
+        virtual void SetStorage(const Storage storage)
+        {
+            m_storage = storage;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Indicate that the values of the configuration will no longer change, so that they can be packed
+         *       according to GetStorage().
+         *
+         *@remarks
+         * - When the values are packed, the slot where they were stored is reused by NewCfg.
+         * - The values of a packed configuration should not be changed, except with CopyCfg or ReadCfg.
+         */
+        virtual void StoreCfg(Cfg & cfg);
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Copy the values of the configuration into <tt>vals</tt>, unpacking them if they have been packed.
+         *
+         *@remarks
+         * - Unlike Cfg::GetValues, the values remain valid for as long as <tt>vals</tt> does.
          */
-        virtual Cfg* NewCfg(void) const
+        virtual void GetValues(const Cfg & cfg, double vals[]) const
         {
-            Cfg *cfg = new Cfg();
-            cfg->SetValues(NewValues());
-            return cfg;
+            if(cfg.IsPacked())
+                cfg.m_packedBy->UnpackValues(cfg, vals);
+            else
+                CopyValues(vals, cfg.GetValues());
         }
 
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Delete the configuration
+         *@brief Unpack the values of a packed configuration into <tt>vals</tt>.
+         */
+        virtual void UnpackValues(const Cfg & cfg, double vals[]) const;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Pack <tt>vals</tt> into the packed values of a packed configuration.
+         */
+        virtual void PackValues(Cfg & cfg, const double vals[]) const;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Get the number of configurations whose values are stored in each chunk.
+         */
+        virtual int GetNrCfgsPerChunk(void) const
+        {
+            return m_nrCfgsPerChunk;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Set the number of configurations whose values are stored in each chunk.
+         *
+         *@remarks
+         * - It should be set before any configuration is created.
+         */
+        virtual void SetNrCfgsPerChunk(const int n)
+        {
+            m_nrCfgsPerChunk = n;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Get the number of configurations whose values have been pooled, i.e., the pool ids are 0, ..., GetNrPooledCfgs() - 1.
+         */
+        virtual int GetNrPooledCfgs(void) const
+        {
+            return m_nrPooledCfgs;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Get the values stored in the slot with the given pool id.
+         *
+         *@remarks
+         * - It should not be called while other threads create configurations.
          */
-        virtual void DeleteCfg(Cfg * cfg)
+        const double* GetPooledValues(const int id) const
         {
-            if(cfg)
-                delete cfg;
+            return SlotValues(id);
         }
 
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Create a new configuration, reusing a deleted one when possible.
+         *
+         *@remarks
+         * - The energy is undefined, there are no cached coordinates, and the values are not initialized.
+         */
+        virtual Cfg* NewCfg(void) const;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Delete the configuration.
+         *
+         *@remarks
+         * - A configuration pooled by this manager is put in the free list so that NewCfg can reuse it.
+         */
+        virtual void DeleteCfg(Cfg * cfg);
+
         /**
          *@author Erion Plaku, Amarda Shehu
          *@brief Copy the configuration values from <tt>cfgSrc</tt> to <tt>cfgDest</tt>.
@@ -100,11 +246,16 @@ namespace Antipatrea
          *@remarks
          *  - It creates a deep copy of the values of <tt>cfgSrc</tt>, not just pointer assignment.
          *  - It also copies the energy value from <tt>cfgSrc</tt> to <tt>cfgDest</tt>
+         *  - Cached coordinates are not copied; those of <tt>cfgDest</tt> are cleared since its values change.
          */
         virtual void CopyCfg(Cfg & cfgDest, const Cfg & cfgSrc) const
         {
-            CopyValues(cfgDest.GetValues(), cfgSrc.GetValues());
+            if(cfgDest.IsPacked())
+                PackValues(cfgDest, cfgSrc.GetValues());
+            else
+                CopyValues(cfgDest.GetValues(), cfgSrc.GetValues());
             cfgDest.SetEnergy(cfgSrc.GetEnergy());
+            cfgDest.ClearCoords();
         }
 
         /**
@@ -144,10 +295,85 @@ namespace Antipatrea
     protected:
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Configuration dimension.
+         *@brief Chunk of configuration values.
+         *
+         *@remarks
+         * - <tt>m_values</tt> is <tt>m_memory</tt> aligned to Constants::VAL_CfgManager_ValuesAlignment doubles.
          */
-        int m_dim;
-        
+        struct Chunk
+        {
+            double *m_memory;
+            double *m_values;
+        };
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return true iff the configuration is stored in a slot of this manager.
+         */
+        bool IsPooled(const Cfg & cfg) const
+        {
+            return
+                cfg.m_poolId >= 0 &&
+                cfg.m_poolId < m_nrPooledCfgs &&
+                SlotValues(cfg.m_poolId) == cfg.m_values;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return the address of the values stored in the slot with the given pool id.
+         */
+        double* SlotValues(const int id) const
+        {
+            return m_chunks[id / m_nrCfgsPerChunk].m_values + (id % m_nrCfgsPerChunk) * m_stride;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Number of configurations per chunk.
+         */
+        int m_nrCfgsPerChunk;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief How StoreCfg keeps the values of stored configurations.
+         */
+        Storage m_storage;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Number of doubles between the values of consecutive slots.
+         */
+        mutable int m_stride;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Number of slots that have been handed out.
+         */
+        mutable int m_nrPooledCfgs;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Chunks of configuration values.
+         */
+        mutable std::vector<Chunk> m_chunks;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Deleted configurations that can be reused.
+         */
+        mutable std::vector<Cfg*> m_freeCfgs;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Slots freed by StoreCfg that can be reused.
+         */
+        mutable std::vector<int> m_freeSlots;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Mutex to create/delete configurations from several threads.
+         */
+        mutable std::mutex m_poolMutex;
     };
     
     /**
@@ -2,35 +2,40 @@
 
 namespace Antipatrea
 {
+    void EST::NeighborhoodVisitFn(const int key, const double, void *data)
+    {
+        NeighborhoodVisitData *vdata = (NeighborhoodVisitData *) data;
+
+        ++(vdata->m_count);
+        if(key != vdata->m_vid)
+        {
+            ESTVertex *v = dynamic_cast<ESTVertex*>(vdata->m_est->GetPlannerGraph()->GetVertex(key));
+            v->SetNrNeighbors(1 + v->GetNrNeighbors());
+            vdata->m_est->UpdateVertexWeight(*v);
+        }
+    }
+
     int EST::AddVertex(Cfg * const cfg)
     {
         const int vid = TreeSamplingBasedPlanner::AddVertex(cfg);
         if(vid >= 0)
         {
-            ProximityQuery<int>   query;
-            ProximityResults<int> results;
-            PlannerGraph         *graph = GetPlannerGraph();
+            NeighborhoodVisitData vdata;
             ESTVertex            *v;
-            
-            query.SetKey(vid);
-            query.SetRange(GetNeighborhoodRadius());
-            query.SetNrNeighbors(graph->GetNrVertices());
-            m_proximityDataStructure.Neighbors(query, results);
 
-            const int n = results.GetNrResults();
-            for(int i = 0; i < n; ++i)
-            {
-                if(results.GetKey(i) != vid)
-                {
-                    v = dynamic_cast<ESTVertex*>(graph->GetVertex(results.GetKey(i)));
-                    m_totalWeight -= GetVertexWeight(*v);
-                    v->SetNrNeighbors(1 + v->GetNrNeighbors());
-                    m_totalWeight += GetVertexWeight(*v);
-                }
-            }
-            v = dynamic_cast<ESTVertex*>(graph->GetVertex(vid));
-            v->SetNrNeighbors(n);
-            m_totalWeight += GetVertexWeight(*v);
+            vdata.m_est   = this;
+            vdata.m_vid   = vid;
+            vdata.m_count = 0;
+            m_proximity->RangeNeighbors(vid, GetNeighborhoodRadius(), NeighborhoodVisitFn, &vdata);
+
+            v = dynamic_cast<ESTVertex*>(GetPlannerGraph()->GetVertex(vid));
+            v->SetNrNeighbors(vdata.m_count);
+
+            auto node = m_selector.Create();
+            node->SetKey(vid);
+            node->SetWeight(GetVertexWeight(*v));
+            m_selector.Insert(node);
+            v->SetSelectorNode(node);
         }
         return vid;
     }
@@ -42,26 +47,12 @@ namespace Antipatrea
     
     int EST::SelectVertex(void) 
     {
-        ESTVertex *v;
-        
-        const double  r     = RandomUniformReal(0, m_totalWeight);
-        PlannerGraph *graph = GetPlannerGraph();
-        double        w     = 0.0;
-
-        for(int i = graph->GetNrVertices() - 1; i >= 0; --i)
-        {
-            v = dynamic_cast<ESTVertex*>(graph->GetVertex(i));
-            w += GetVertexWeight(*v);
-            if(w >= r)
-            {
-                v->SetNrSelections(1 + v->GetNrSelections());
-                return i;
-            }
-        }
+        const int  vid = m_selector.Select()->GetKey();
+        ESTVertex *v   = dynamic_cast<ESTVertex*>(GetPlannerGraph()->GetVertex(vid));
 
-        v = dynamic_cast<ESTVertex*>(graph->GetVertex(0));
         v->SetNrSelections(1 + v->GetNrSelections());
+        UpdateVertexWeight(*v);
 
-        return 0;
+        return vid;
     }
 }
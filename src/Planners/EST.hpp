@@ -3,6 +3,7 @@
 
 #include "Planners/TreeSamplingBasedPlanner.hpp"
 #include "Setup/Defaults.hpp"
+#include "Utils/Selector.hpp"
 
 namespace Antipatrea
 {
@@ -21,7 +22,8 @@ namespace Antipatrea
     public:
         ESTVertex(void) : PlannerVertex(),
                           m_nrNeighbors(0),
-                          m_nrSel(0)
+                          m_nrSel(0),
+                          m_selectorNode(NULL)
         {
         }
 
@@ -64,6 +66,24 @@ namespace Antipatrea
         {
             m_nrSel = nrSel;
         }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Get the node that holds the weight of the vertex in the EST selector.
+         */
+        virtual Selector<int>::Node* GetSelectorNode(void) const
+        {
+            return m_selectorNode;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Set the node that holds the weight of the vertex in the EST selector.
+         */
+        virtual void SetSelectorNode(Selector<int>::Node * const node)
+        {
+            m_selectorNode = node;
+        }
         
     protected:
         /**
@@ -78,7 +98,12 @@ namespace Antipatrea
          *@brief Number of times a vertex has been selected for tree expansions.
          */
         int m_nrSel;
-        
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Node that holds the weight of the vertex in the EST selector (owned by the selector).
+         */
+        Selector<int>::Node *m_selectorNode;
     };
 
         
@@ -86,8 +111,7 @@ namespace Antipatrea
     {
     public:
         EST(void) : TreeSamplingBasedPlanner(),
-                    m_neighborhoodRadius(Constants::VAL_EST_NeighborhoodRadius),
-                    m_totalWeight(0.0)
+                    m_neighborhoodRadius(Constants::VAL_EST_NeighborhoodRadius)
         {
         }
 
@@ -169,6 +193,7 @@ namespace Antipatrea
          *   <tt>cfg</tt> is no more than <tt>GetNeighboorhodRadius().</tt> For each
          *   of these configurations, it also increments the number of neighbors counter
          *   by one (since <tt>cfg</tt> will be inside their neighborhoods).
+         * - The neighborhood is obtained with a range query, so no result arrays are allocated.
          * 
          * - The function does not make a copy of <tt>cfg</tt>; it simply does pointer assignment.
          * - The function does not check if <tt>cfg</tt> is already in the graph. It is the 
@@ -177,6 +202,29 @@ namespace Antipatrea
          *   graph multiple times (which even if it happened would not cause any errors).
          */
         virtual int AddVertex(Cfg * const cfg);
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Data passed to NeighborhoodVisitFn when querying the neighborhood of a new vertex.
+         */
+        struct NeighborhoodVisitData
+        {
+            EST *m_est;
+            int  m_vid;
+            int  m_count;
+        };
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Count a vertex inside the neighborhood of the new vertex and increment
+         *       its own number of neighbors.
+         *
+         *@remarks
+         * - It is invoked by the proximity data structure for each vertex within
+         *   GetNeighborhoodRadius() (see Proximity::RangeNeighbors), so AddVertex
+         *   takes time proportional to the size of the neighborhood rather than to the size of the tree.
+         */
+        static void NeighborhoodVisitFn(const int key, const double d, void *data);
         
         /**
          *@author Erion Plaku, Amarda Shehu
@@ -190,6 +238,19 @@ namespace Antipatrea
          */
         virtual double GetVertexWeight(const ESTVertex & v) const;
 
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Update the weight of the vertex in the selector after its number of
+         *       neighbors or selections has changed.
+         *
+         *@remarks
+         * - It takes time logarithmic in the number of vertices.
+         */
+        virtual void UpdateVertexWeight(ESTVertex & v)
+        {
+            m_selector.Update(v.GetSelectorNode(), GetVertexWeight(v));
+        }
+
         /**
          *@author Erion Plaku, Amarda Shehu
          *@brief Select a vertex from which to expand the tree and 
@@ -198,6 +259,8 @@ namespace Antipatrea
          *@remarks
          * - Function returns the id of the selected vertex.
          * - The vertex is selected with probability proportional to its weight.
+         * - The weights are kept in a sum tree (see Selector), so selection takes
+         *   time logarithmic in the number of vertices.
          * - TreeSamplingBasedPlanner::SelectTarget is used to select the target.
          */
         virtual int SelectVertex(void);
@@ -211,10 +274,10 @@ namespace Antipatrea
 
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Sum of weights of associates with the tree vertices.
+         *@brief Weights of the tree vertices, keyed by vertex id.
          */
-        double m_totalWeight;
-        
+        Selector<int> m_selector;
+
     };
     
     /**
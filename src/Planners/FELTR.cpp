@@ -2,6 +2,7 @@
 #include <Components/CfgAcceptors/CfgAcceptorBasedOnMMC.hpp>
 #include <Components/CfgAcceptors/CfgAcceptorBasedOnFixedMMC.hpp>
 #include <math.h>
+#include <iterator>
 
 #include <iostream>
 
@@ -22,8 +23,8 @@ namespace Antipatrea
 
         int regionID = m_energyGrid.GetCellIdFromPoint(projection);
 
-        auto regionNode = GetEnergyRegion(projection);
-        auto region = regionNode->GetKey();
+        const int regionSlot = GetEnergyRegion(projection);
+        auto region = m_selector.GetKey(regionSlot);
         int vid = -1;
         if (region->CheckVertex(cfg,projection))
         {
@@ -37,7 +38,8 @@ namespace Antipatrea
                 m_totalEnergy        += cfg->GetEnergy();
                 m_totalEnergySquared += pow(cfg->GetEnergy(),2);
                 m_nodeCount++;
-                m_selector.Update(regionNode,region->GetWeight());
+                m_selector.Update(regionSlot,region->GetWeight());
+                UpdateRegionEnergyIndex(regionSlot);
             }
         }
 
@@ -47,7 +49,7 @@ namespace Antipatrea
     }
 
 
-    Selector<FELTRRegion *>::Node * FELTR::GetEnergyRegion(double projection[])
+    int FELTR::GetEnergyRegion(double projection[])
     {
         int regionID = m_energyGrid.GetCellIdFromPoint(projection);
         // is this a new region?
@@ -55,7 +57,7 @@ namespace Antipatrea
 
         FELTRRegion * region;
 
-        Selector<FELTRRegion *>::Node *regionNode;
+        int regionSlot;
 
         const bool newRegion = (iter == m_FELTRRegionToSelectorMap.end());
         if (newRegion)
@@ -76,73 +78,105 @@ namespace Antipatrea
 
             region = new FELTRRegion(regionID,m_cellGridGranularity,cfgDims,m_weightScheme);
             region->SetCfgDistance(GetCfgDistance());
+            region->SetUseCellIndex(m_useCellIndex);
 
-            regionNode = m_selector.Create();
-            regionNode->SetKey(region);
-            regionNode->SetWeight(1);
-            m_selector.Insert(regionNode);
-            m_FELTRRegionToSelectorMap.insert(std::make_pair(regionID,regionNode));
+            regionSlot = m_selector.Insert(region, 1);
+            if (regionSlot >= (int) m_regionMinEEntries.size())
+                m_regionMinEEntries.resize(regionSlot + 1, m_regionsByMinE.end());
+            m_FELTRRegionToSelectorMap.insert(std::make_pair(regionID,regionSlot));
         }
         else
         {
-            regionNode = iter->second;
+            regionSlot = iter->second;
         }
-        return(regionNode);
+        return(regionSlot);
     }
 
-    Selector<FELTRRegion *>::Node * FELTR::SelectNORM(void)
+    int FELTR::SelectNORM(void)
     {
+    	if (m_regionsByMinE.empty())
+    		return -1;
+
     	double mu = m_totalEnergy/m_nodeCount;
     	double stdDev = sqrt(m_totalEnergySquared/m_nodeCount - pow(mu,2));
     	std::normal_distribution<double> d(mu,stdDev);
 
     	double sampledEnergy = d(generator);
 
-    	double thisProjection[4] = {1, 1, 1, sampledEnergy};
+    	// the USR coordinates have a single cell in the energy grid
+    	double thisProjection[FELTR_PROJECTION_COORDS];
+    	for (unsigned int i(0);i < FELTR_USR_COORDS;++i)
+    		thisProjection[i] = 0;
+    	thisProjection[FELTR_ENERGY_COORD_OFFSET] = sampledEnergy;
 
     	int regionID = m_energyGrid.GetCellIdFromPoint(thisProjection);
     	auto iter = m_FELTRRegionToSelectorMap.find(regionID);
-    	Selector<FELTRRegion*>::Node * nodeRegion;
+    	int nodeRegion = -1;
 
-    	if (iter == m_FELTRRegionToSelectorMap.end())
+    	if (iter != m_FELTRRegionToSelectorMap.end() &&
+    		m_regionMinEEntries[iter->second] != m_regionsByMinE.end())
     	{
-
-    		double minDist = 999999999999.99;
-    		for (auto iter2 = m_FELTRRegionToSelectorMap.begin();iter2 != m_FELTRRegionToSelectorMap.end();iter2++)
-    		{
-    			if (iter2->second->GetKey()->GetMinE() < minDist)
-    			{
-    				minDist = iter2->second->GetKey()->GetMinE();
-    				nodeRegion = iter2->second;
-    			}
-    		}
+    		nodeRegion = iter->second;
     	}
     	else
     	{
-    		nodeRegion = iter->second;
+    		// closest populated region by minimum energy
+    		auto above = m_regionsByMinE.lower_bound(sampledEnergy);
+
+    		if (above == m_regionsByMinE.end())
+    			nodeRegion = std::prev(above)->second;
+    		else if (above == m_regionsByMinE.begin())
+    			nodeRegion = above->second;
+    		else
+    		{
+    			auto below = std::prev(above);
+    			nodeRegion = (sampledEnergy - below->first <= above->first - sampledEnergy) ?
+    				below->second : above->second;
+    		}
     	}
 
     	/* std::cout << "Norm mu:" << mu << " std:" << stdDev << " selected energy level:" << sampledEnergy
-    			  << " energy of region:" << nodeRegion->GetKey()->GetMinE() << "\n"; */
+    			  << " energy of region:" << m_selector.GetKey(nodeRegion)->GetMinE() << "\n"; */
 
     	return nodeRegion;
     }
 
 
 
+    void FELTR::UpdateRegionEnergyIndex(const int regionSlot)
+    {
+        auto region = m_selector.GetKey(regionSlot);
+        auto &entry = m_regionMinEEntries[regionSlot];
+
+        if (region->GetNrConfs() == 0)
+            return;
+
+        if (entry != m_regionsByMinE.end())
+        {
+            if (entry->first == region->GetMinE())
+                return;
+            m_regionsByMinE.erase(entry);
+        }
+        entry = m_regionsByMinE.insert(std::make_pair(region->GetMinE(), regionSlot));
+    }
+
+
     int FELTR::SelectVertex(void)
     {
-    	Selector<FELTRRegion *>::Node * regionNode;
+    	int regionSlot;
 
     	if (m_weightScheme == NORM) {
-    		regionNode = SelectNORM();
+    		regionSlot = SelectNORM();
     	}
     	else
     	{
-    		regionNode = m_selector.Select();
+    		regionSlot = m_selector.Select();
     	}
 
-        auto region = regionNode->GetKey();
+    	if (regionSlot < 0)
+    		return -1;
+
+        auto region = m_selector.GetKey(regionSlot);
 
         if (m_verbosityFlag == SAMPLING_PLANNER_VERBOSE_LOW)
         {
@@ -15,7 +15,9 @@
 #include "Planners/FELTRRegion.hpp"
 #include "Utils/Grid.hpp"
 
+#include <map>
 #include <random>
+#include <vector>
 
 namespace Antipatrea
 {
@@ -73,7 +75,8 @@ namespace Antipatrea
                      m_cellGridGranularity(Constants::VAL_CellGrid_Granularity),
 					 m_totalEnergy(0.0),
 					 m_totalEnergySquared(0.0),
-					 m_nodeCount(0)
+					 m_nodeCount(0),
+					 m_useCellIndex(Constants::VAL_FELTR_CellIndex)
         {
         }
 
@@ -115,6 +118,8 @@ namespace Antipatrea
                                                                     m_energyGridMin));
                 m_energyGridMax = (data->m_params->GetValueAsDouble(Constants::KW_FELTR_ENERGYGRID_MAX,
                                                                     m_energyGridMax));
+                m_useCellIndex = data->m_params->GetValueAsBool(Constants::KW_FELTR_CELL_INDEX,
+                                                                m_useCellIndex);
                 auto weightScheme = data->m_params->GetValue(Constants::KW_FELTR_ENERGYWEIGHT_SCHEME);
 
                 if (StrSameContent(weightScheme, Constants::VAL_FELTR_ENERGY_QUAD))
@@ -182,7 +187,7 @@ namespace Antipatrea
           *@brief  Given a 4d FELTR projection, return a FELTRRegion from the
           *        SELECTOR structure (not the graph).
           */
-        virtual Selector<FELTRRegion *>::Node * GetEnergyRegion(double projection[]);
+        virtual int GetEnergyRegion(double projection[]);
 
         /**
           *@author Kevin Molloy, Erion Plaku, Amarda Shehu
@@ -207,7 +212,26 @@ namespace Antipatrea
          */
         virtual int SelectVertex(void);
 
-        virtual Selector<FELTRRegion *>::Node *  SelectNORM(void);
+        /**
+          *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+          *@brief  Sample an energy from a normal distribution fitted to the
+          *        energies of the tree vertices and return the selector slot
+          *        of the region with that energy.
+          *
+          *@remarks
+          * - If that region has no vertices, the populated region whose minimum
+          *   energy is closest to the sampled energy is used instead. It is found
+          *   in logarithmic time with m_regionsByMinE.
+          * - It returns <tt>-1</tt> if no region has vertices.
+          */
+        virtual int SelectNORM(void);
+
+        /**
+          *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+          *@brief  Update the position of the region in m_regionsByMinE
+          *        after vertices have been added to it.
+          */
+        virtual void UpdateRegionEnergyIndex(const int regionSlot);
 
         /**
           *@author Kevin Molloy, Erion Plaku, Amarda Shehu
@@ -257,7 +281,7 @@ namespace Antipatrea
           *        their associated weight).
           */
 
-        Selector<FELTRRegion *> m_selector;
+        SelectorArray<FELTRRegion *> m_selector;
 
         /**
           *@author Kevin Molloy, Erion Plaku, Amarda Shehu
@@ -265,9 +289,34 @@ namespace Antipatrea
           *        cooresponding node within the selector tree.
           */
 
-        std::map<int,Selector<FELTRRegion*>::Node *> m_FELTRRegionToSelectorMap;
+        std::map<int,int> m_FELTRRegionToSelectorMap;
+
+        /**
+          *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+          *@brief  Populated regions ordered by their minimum energy
+          *        (maps the minimum energy to the selector slot).
+          *
+          *@remarks
+          * - The first entry gives the region with the lowest energy.
+          */
+        std::multimap<double,int> m_regionsByMinE;
+
+        /**
+          *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+          *@brief  Entry of each region in m_regionsByMinE, indexed by
+          *        selector slot (<tt>m_regionsByMinE.end()</tt> if the region has no vertices).
+          */
+        std::vector<std::multimap<double,int>::iterator> m_regionMinEEntries;
 
         int    m_nodeCount;
+
+        /**
+          *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+          *@brief  Whether cells use a metric index for the granularity-reduction
+          *        duplicate checks (keyword Constants::KW_FELTR_CELL_INDEX).
+          */
+        bool   m_useCellIndex;
+
         double m_totalEnergy;
         double m_totalEnergySquared;
         double m_energyCellSize;
@@ -7,6 +7,8 @@
 
 #include "Planners/FELTRRegion.hpp"
 #include "Planners/FELTRCell.hpp"
+#include <algorithm>
+#include <cmath>
 
 namespace Antipatrea
 {
@@ -21,21 +23,51 @@ namespace Antipatrea
         // add to the cell
         UpdateWeightOnInsert();
 
-        auto newNode = m_insideCellSelector.Create();
-        newNode->SetKey(vid);
-        newNode->SetWeight(1.0);
-
-        m_insideCellSelector.Insert(newNode);
+        m_insideCellSelector.Insert(vid, 1.0);
         m_cfgs.push_back(cfg);
+        if (m_useIndex)
+            AddToIndex();
+    }
+
+    void FELTRCell::AddToIndex(void)
+    {
+        auto       distF = GetCfgDistance();
+        const Cfg *cfg   = m_cfgs.back();
+        const int  i     = m_cfgs.size() - 1;
+        const int  np    = std::min(i, (int) NR_PIVOTS);
+        IndexEntry entry;
+
+        // reuse the key and pivot distances computed when cfg was checked
+        const bool cached = (m_lastQuery == cfg && m_lastQueryNrPivots == np);
+
+        entry.m_key = cached ? m_lastQueryKey : distF->LowerBoundKey(*cfg);
+        entry.m_cfg = i;
+        m_index.insert(std::upper_bound(m_index.begin(), m_index.end(), entry), entry);
+
+        m_pivotDists.resize(m_cfgs.size() * NR_PIVOTS, 0.0);
+
+        double *dists = &m_pivotDists[i * NR_PIVOTS];
+
+        if (cached)
+            std::copy(m_lastQueryPivotDists, m_lastQueryPivotDists + np, dists);
+        else if (np > 0)
+            distF->Distances(*cfg, np, &m_cfgs[0], dists);
+
+        // a new pivot: its distances to the earlier cfgs are symmetric
+        if (i < NR_PIVOTS)
+            for (int j = 0; j < i; ++j)
+                m_pivotDists[j * NR_PIVOTS + i] = dists[j];
+
+        m_lastQuery = NULL;
     }
 
     int FELTRCell::SelectVertex(void)
     {
-        auto node = m_insideCellSelector.Select();
+        const int slot = m_insideCellSelector.Select();
 
-        assert(node->GetWeight() == 1.0); // all nodes should have weight 1 in cell
+        assert(m_insideCellSelector.GetWeight(slot) == 1.0); // all nodes should have weight 1 in cell
 
-        int  v    = node->GetKey();
+        int  v    = m_insideCellSelector.GetKey(slot);
 
         UpdateWeightOnSelection(1);
         // m_selector.Update(node, GetWeight());
@@ -43,18 +75,97 @@ namespace Antipatrea
         return v;
     }
 
+    bool FELTRCell::SimilarCfgExistsIndexed(Cfg * const cfg, double & dist)
+    {
+        auto         distF = GetCfgDistance();
+        const int    n     = m_cfgs.size();
+        const int    np    = std::min(n, (int) NR_PIVOTS);
+        const double key   = distF->LowerBoundKey(*cfg);
+        double      *dq    = m_lastQueryPivotDists;
+
+        m_lastQuery         = cfg;
+        m_lastQueryKey      = key;
+        m_lastQueryNrPivots = np;
+
+        if (np > 0)
+            distF->Distances(*cfg, np, &m_cfgs[0], dq);
+        for (int p = 0; p < np; ++p)
+            if (dq[p] < m_threshold)
+            {
+                dist = dq[p];
+                return true;
+            }
+
+        const Cfg *batch[SIMILAR_CFG_BATCH_SIZE];
+        double     dists[SIMILAR_CFG_BATCH_SIZE];
+        int        m = 0;
+        IndexEntry lower;
+
+        // score the candidates gathered so far and report the first hit
+        auto scoreBatch = [&](void)
+        {
+            distF->Distances(*cfg, m, batch, dists);
+            for (int j = 0; j < m; ++j)
+                if (dists[j] < m_threshold)
+                {
+                    dist = dists[j];
+                    return true;
+                }
+            m = 0;
+            return false;
+        };
+
+        lower.m_key = key - m_threshold;
+        for (auto iter = std::lower_bound(m_index.begin(), m_index.end(), lower);
+             iter != m_index.end() && iter->m_key - key < m_threshold; ++iter)
+        {
+            const int c = iter->m_cfg;
+
+            if (c < np)
+                continue;
+
+            const double *dc = &m_pivotDists[c * NR_PIVOTS];
+            bool          far = false;
+
+            for (int p = 0; p < np && !far; ++p)
+                far = fabs(dq[p] - dc[p]) >= m_threshold;
+            if (far)
+                continue;
+
+            batch[m++] = m_cfgs[c];
+            if (m == SIMILAR_CFG_BATCH_SIZE && scoreBatch())
+                return true;
+        }
+
+        return m > 0 && scoreBatch();
+    }
+
     bool FELTRCell::SimilarCfgExists(Cfg * const cfg)
     {
         auto distF = GetCfgDistance();
         bool foundSimilar = false;
         double dist = 999.99;
-        for (auto c : m_cfgs)
+        double dists[SIMILAR_CFG_BATCH_SIZE];
+        const int n = m_cfgs.size();
+
+        if (m_useIndex)
+            foundSimilar = SimilarCfgExistsIndexed(cfg, dist);
+
+        // score the cell cfgs in small batches so that the distance can
+        // evaluate many at once, while still stopping soon after a hit
+        for (int i = 0; i < n && !foundSimilar && !m_useIndex; i += SIMILAR_CFG_BATCH_SIZE)
         {
-            dist = distF->Distance(*cfg,*c);
-            if (dist < m_threshold)
+            const int m = std::min(n - i, (int) SIMILAR_CFG_BATCH_SIZE);
+
+            distF->Distances(*cfg, m, &m_cfgs[i], dists);
+            for (int j = 0; j < m; ++j)
             {
-                foundSimilar = true;
-                break;
+                if (dists[j] < m_threshold)
+                {
+                    dist = dists[j];
+                    foundSimilar = true;
+                    break;
+                }
             }
         }
 
@@ -23,7 +23,7 @@
 #include "Planners/TreeSamplingBasedPlanner.hpp"
 
 #include <Utils/Grid.hpp>
-#include <Utils/Selector.hpp>
+#include <Utils/SelectorArray.hpp>
 #include "Planners/FELTR.hpp"
 
 // typedef double Id;
@@ -62,6 +62,10 @@ namespace Antipatrea
                          , m_newPaths(0)
                          , m_threshold(0.25)
                          , m_reductionCount(1)
+                         , m_useIndex(Constants::VAL_FELTR_CellIndex)
+                         , m_lastQuery(NULL)
+                         , m_lastQueryKey(0.0)
+                         , m_lastQueryNrPivots(0)
         {
         }
 
@@ -131,6 +135,18 @@ namespace Antipatrea
            */
 
         bool SimilarCfgExists(Cfg * const cfg);
+
+        /**
+           *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+           *@brief  Enable/disable the metric index used by SimilarCfgExists.
+           *
+           *@remarks
+           * - It should be set before any vertex is added to the cell.
+           */
+        void SetUseIndex(const bool useIndex)
+        {
+            m_useIndex = useIndex;
+        }
         //----------------------------------------------------------------------------
 
 
@@ -159,15 +175,85 @@ namespace Antipatrea
             m_weight = 1.0 / ((double) (1.0 + m_nsel) * m_nconfs);
         }
 
+        /**
+           *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+           *@brief  Number of cell cfgs scored per CfgDistance::Distances call
+           *        in SimilarCfgExists.
+           */
+        enum
+            {
+                SIMILAR_CFG_BATCH_SIZE = 16
+            };
+
+        /**
+           *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+           *@brief  Number of cell cfgs used as pivots by the metric index.
+           *
+           *@remarks
+           * - The first NR_PIVOTS cfgs added to the cell are the pivots.
+           *   The distance from each cfg to each pivot is stored when the cfg is added.
+           * - By the triangle inequality, <tt>|d(q, p) - d(c, p)|</tt> is a lower bound on <tt>d(q, c)</tt>.
+           */
+        enum
+            {
+                NR_PIVOTS = 4
+            };
+
+        /**
+           *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+           *@brief  Entry of the metric index: CfgDistance::LowerBoundKey of a cell cfg
+           *        and the position of the cfg in m_cfgs.
+           */
+        struct IndexEntry
+        {
+            double m_key;
+            int    m_cfg;
+
+            bool operator<(const IndexEntry & other) const
+            {
+                return m_key < other.m_key;
+            }
+        };
+
+        /**
+           *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+           *@brief  Return true iff a cell cfg is within m_threshold of <tt>cfg</tt>, using the metric index.
+           *
+           *@remarks
+           * - It first compares <tt>cfg</tt> to the pivots.
+           * - It then considers only the cfgs whose CfgDistance::LowerBoundKey differs from that of
+           *   <tt>cfg</tt> by less than m_threshold (a binary search in m_index), and discards those
+           *   ruled out by the pivot distances.
+           * - The remaining cfgs are scored in batches, stopping at the first one within m_threshold.
+           * - The key and pivot distances of <tt>cfg</tt> are kept, since FELTR adds <tt>cfg</tt> to
+           *   the cell right after checking it.
+           */
+        bool SimilarCfgExistsIndexed(Cfg * const cfg, double & dist);
+
+        /**
+           *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+           *@brief  Add the last cfg of m_cfgs to the metric index.
+           */
+        void AddToIndex(void);
+
         int weightType;
         int           m_nsel;   //number of times cell has been selected
         double        m_weight;
         int           m_nconfs;
         double        m_threshold;
-        Selector<int> m_insideCellSelector;
+        SelectorArray<int> m_insideCellSelector;
         unsigned int  m_reductionCount;
         std::vector<const Cfg *> m_cfgs;
 
+        bool                     m_useIndex;
+        std::vector<IndexEntry>  m_index;       // sorted by key
+        std::vector<double>      m_pivotDists;  // NR_PIVOTS values per cfg in m_cfgs
+
+        const Cfg               *m_lastQuery;
+        double                   m_lastQueryKey;
+        int                      m_lastQueryNrPivots;
+        double                   m_lastQueryPivotDists[NR_PIVOTS];
+
         int m_newPaths;
         int m_id;  // key that was used to map to this cell
                    // used to verify pointers are not getting crossed
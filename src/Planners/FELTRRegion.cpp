@@ -17,11 +17,9 @@ namespace Antipatrea
         // see if CELL needs to be created
         auto iter =  m_CellToSelectorMap.find(cellId);
         bool newCell = (iter == m_CellToSelectorMap.end());
-        Selector<FELTRCell *>::Node *cellNode;
         if (!newCell)
         {
-            cellNode = iter->second;
-            FELTRCell *cell = cellNode->GetKey();
+            FELTRCell *cell = m_selector.GetKey(iter->second);
             if (cell->SimilarCfgExists(cfg) == true)
                 vertexOK = false;
         }
@@ -56,41 +54,39 @@ namespace Antipatrea
         bool newCell = (iter == m_CellToSelectorMap.end());
 
         cell = NULL;
-        Selector<FELTRCell *>::Node *cellNode;
+        int cellSlot;
         if (newCell)
         {
             cell = new FELTRCell();
             cell->SetCfgDistance(GetCfgDistance());
             cell->SetId(cellId);
-            cellNode = m_selector.Create();
-            cellNode->SetKey(cell);
-            cellNode->SetWeight(cell->GetWeight());
+            cell->SetUseIndex(m_useCellIndex);
 
             // std::cout << "Creating new cell with id:" << cellId << "\n"; //KMDEBUG
 
 
-            m_selector.Insert(cellNode);
+            cellSlot = m_selector.Insert(cell, cell->GetWeight());
 
-            m_CellToSelectorMap.insert(std::make_pair(cellId,cellNode));
+            m_CellToSelectorMap.insert(std::make_pair(cellId,cellSlot));
         }
         else
         {
             // std::cout << "Found cell with id:" << cellId << "\n";
-            cellNode = iter->second;
-            cell = cellNode->GetKey();
+            cellSlot = iter->second;
+            cell = m_selector.GetKey(cellSlot);
         }
 
         UpdateWeightOnEnergy(p[3]);
         cell->AddVertex(vid,cfg);
 
-        m_selector.Update(cellNode,cell->GetWeight());
+        m_selector.Update(cellSlot,cell->GetWeight());
     }
 
 
     int FELTRRegion::SelectVertex(void)
     {
-        Selector<FELTRCell *>::Node *cellNode = m_selector.Select();
-        FELTRCell                   *cell     = cellNode->GetKey();
+        const int  cellSlot = m_selector.Select();
+        FELTRCell *cell     = m_selector.GetKey(cellSlot);
 
         //DEBUG
         double oldWeight = cell->GetWeight();
@@ -98,10 +94,10 @@ namespace Antipatrea
         int v        = cell->SelectVertex();
 
        	//std::cout << "SELECTvid:" << v << ":region:" << m_id << ":cellid:" << cell->GetId() << ":CellsInThisRegion:"
-       	//		  << m_selector.GetNrNodes() << ":cfgsInThisCell:"
+       	//		  << m_selector.GetNrItems() << ":cfgsInThisCell:"
         //          << cell->GetNrConfs() << ":ocw:" << oldWeight << ":ncw:" << cell->GetWeight() << "\n";
 
-        m_selector.Update(cellNode, cell->GetWeight());
+        m_selector.Update(cellSlot, cell->GetWeight());
 
         UpdateWeightOnSelection(1);
 
@@ -23,7 +23,7 @@
 #include "Planners/TreeSamplingBasedPlanner.hpp"
 
 #include <Utils/Grid.hpp>
-#include <Utils/Selector.hpp>
+#include <Utils/SelectorArray.hpp>
 #include "Planners/FELTR.hpp"
 #include "Planners/FELTRRegion.hpp"
 #include "Planners/FELTRCell.hpp"
@@ -49,7 +49,8 @@ namespace Antipatrea
                             m_weight(0.0),
                             m_newPaths(0),
                             m_gridCells(NULL),
-							m_weightFunction(QUAD)
+							m_weightFunction(QUAD),
+                            m_useCellIndex(Constants::VAL_FELTR_CellIndex)
         {
         }
 
@@ -63,7 +64,8 @@ namespace Antipatrea
                 m_newPaths(0),
                 m_objDim(objDim),
                 m_reductionCount(0),
-                m_weightFunction(weightFunction)
+                m_weightFunction(weightFunction),
+                m_useCellIndex(Constants::VAL_FELTR_CellIndex)
         {
              // double minRg = get_constrained_R0(m_objDim - (FRAG_LENGTH - 1)) - 1.0;
             double minRg = get_constrained_R0(m_objDim - (3 - 1)) - 1.0;
@@ -154,6 +156,11 @@ namespace Antipatrea
         bool CheckVertex(Cfg * const cfg,
                          double []);
 
+        void SetUseCellIndex(const bool useCellIndex)
+        {
+            m_useCellIndex = useCellIndex;
+        }
+
     protected:
         void UpdateWeightOnSelection(const int nsel)
         {
@@ -177,8 +184,8 @@ namespace Antipatrea
         //--------------------------------------------------------------------------
         void UpdateWeightP(unsigned int power)
         {
-            //m_weight = m_sumE / ((double) (1.0 + m_nsel) * m_selector.GetNrNodes());
-            //m_weight = 1.0 / ((double) (1.0 + m_nsel) * m_selector.GetNrNodes());
+            //m_weight = m_sumE / ((double) (1.0 + m_nsel) * m_selector.GetNrItems());
+            //m_weight = 1.0 / ((double) (1.0 + m_nsel) * m_selector.GetNrItems());
             //            m_weight = TreeVertex::ComputeWeight(m_nsel, m_sumE/m_nrConfs);
             double averageEnergy = GetAvgE();
 
@@ -217,8 +224,8 @@ namespace Antipatrea
 
         double           m_weight;
 
-        Selector<FELTRCell *> m_selector;
-        std::map<int, Selector<FELTRCell *>::Node *> m_CellToSelectorMap;
+        SelectorArray<FELTRCell *> m_selector;
+        std::map<int, int> m_CellToSelectorMap;
 
         Grid *m_gridCells;
         int m_id;
@@ -226,6 +233,7 @@ namespace Antipatrea
         unsigned int m_objDim;
         unsigned int  m_reductionCount;
         unsigned int m_weightFunction;
+        bool m_useCellIndex;
     }; // FELTRRegion
 }
 
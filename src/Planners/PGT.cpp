@@ -8,8 +8,8 @@ namespace Antipatrea
     PGT::~PGT(void)
     {
         for(auto & cell : m_cells)
-            if(cell.second)
-                delete cell.second;
+            if(cell)
+                delete cell;
     }
 
     void PGT::SetupFromParams(Params & params)
@@ -37,21 +37,19 @@ namespace Antipatrea
 
             cfgProjector->Project(*cfg, cfgProj);
 
-            Cell     *cell;
-            const int cid = m_grid.GetCellId(cfgProj);
-            auto      curr= m_cells.find(cid);
+            const int cid  = m_grid.GetCellId(cfgProj);
+            int       slot = m_cellSelector.Find(cid);
 
-            if(curr == m_cells.end())
+            if(slot < 0)
             {
-                cell = NewCell();
-                m_cells.insert(std::make_pair(cid, cell));
+                slot = m_cellSelector.Insert(cid, 0.0);
+                m_cells.push_back(NewCell());
             }
-            else
-                cell = curr->second;
-            
-            m_totalWeight -= cell->GetWeight();
+
+            Cell *cell = m_cells[slot];
+
             cell->AddVertex(vid);
-            m_totalWeight += cell->GetWeight();
+            m_cellSelector.Update(slot, cell->GetWeight());
 
             cfgProjector->DeleteValues(cfgProj);
             
@@ -61,16 +59,17 @@ namespace Antipatrea
 
     int PGT::SelectVertex(void) 
     {
-        const double  r     = RandomUniformReal(0, m_totalWeight);
-        double        w     = 0.0;
+        const int slot = m_cellSelector.Select();
 
-        for(auto & cell : m_cells)
-        {
-            w += cell.second->GetWeight();
-            if(w >= r)
-                return cell.second->SelectVertex();
-        }
-        
-        return RandomUniformInteger(0, GetPlannerGraph()->GetNrVertices() - 1);
+        if(slot < 0)
+            return -1;
+
+        Cell     *cell = m_cells[slot];
+        const int vid  = cell->SelectVertex();
+
+        //selection changes the cell weight
+        m_cellSelector.Update(slot, cell->GetWeight());
+
+        return vid;
     }
 }
@@ -5,6 +5,8 @@
 #include "Components/CfgProjectors/CfgProjector.hpp"
 #include "Setup/Defaults.hpp"
 #include "Utils/Grid.hpp"
+#include "Utils/SelectorArray.hpp"
+#include <vector>
 
 namespace Antipatrea
 {
@@ -45,7 +47,7 @@ namespace Antipatrea
     public:
         PGT(void) : TreeSamplingBasedPlanner(),
                     CfgProjectorContainer(),
-                    m_totalWeight(0.0)
+                    m_cellSelector(true)
         {
         }
         
@@ -127,6 +129,9 @@ namespace Antipatrea
          * - The vertex is selected by first selecting a grid cell (among the non-empty grid cells)
          *   with probability proportional to its weight and then selecting a vertex
          *   uniformly at random from the vertices associated with the selected grid cell.
+         * - The cell weights are kept in a sum tree (SelectorArray), so selecting a cell
+         *   takes logarithmic time in the number of non-empty cells.
+         * - The function returns <tt>-1</tt> when there are no non-empty cells.
          * - TreeSamplingBasedPlanner::SelectTarget is used to select the target.
          */
         virtual int SelectVertex(void);
@@ -219,21 +224,24 @@ namespace Antipatrea
         
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Sum of weights of the non-empty grid cells.
+         *@brief Grid over the projection space.
          */
-        double m_totalWeight;
+        Grid m_grid;
         
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Grid over the projection space.
+         *@brief Weights of the non-empty grid cells, keyed by grid cell id.
+         *
+         *@remarks
+         * - The slot of each cell in the selector is its index in <tt>m_cells</tt>.
          */
-        Grid m_grid;
-        
+        SelectorArray<int> m_cellSelector;
+
         /**
          *@author Erion Plaku, Amarda Shehu
          *@brief Non-empty grid cells.
          */
-        std::unordered_map<int, Cell*> m_cells;
+        std::vector<Cell*> m_cells;
     };
 
     /**
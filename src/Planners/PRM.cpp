@@ -3,6 +3,7 @@
 #include "Utils/Timer.hpp"
 #include "Utils/Stats.hpp"
 #include "Utils/Logger.hpp"
+#include <algorithm>
 
 #include "Components/CfgAcceptors/CfgAcceptorBasedOnMMC.hpp"
 #include "Components/CfgAcceptors/CfgAcceptorBasedOnFixedMMC.hpp"
@@ -87,11 +88,28 @@ namespace Antipatrea
                 Timer::Clock clk;
                 Timer::Start(clk);
 
+                std::vector<ProximityQuery<int> >   queries;
+                std::vector<ProximityResults<int> > results;
+
                 while(IsSolved() == false &&
                           Timer::Elapsed(clk) < tmax &&
                           m_vidsToBeConnected.empty() == false)
                 {
-                        GenerateEdgesForVertex(*(m_vidsToBeConnected.begin()));
+                        const int n = std::min((int) m_vidsToBeConnected.size(),
+                                               std::max(1, GetBatchSizeToGenerateVertices()));
+                        auto      iter = m_vidsToBeConnected.begin();
+
+                        queries.resize(n);
+                        results.resize(n);
+                        for(int i = 0; i < n; ++i, ++iter)
+                        {
+                                queries[i].SetNrNeighbors(GetNrNeighbors());
+                                queries[i].SetKey(*iter);
+                        }
+                        ApproximateNeighbors(n, &queries[0], &results[0]);
+
+                        for(int i = 0; i < n && IsSolved() == false && Timer::Elapsed(clk) < tmax; ++i)
+                                GenerateEdgesForVertex(queries[i].GetKey(), results[i]);
                 }
 
                 Stats::GetSingleton()->AddValue(Constants::KW_Runtime_PRM_GenerateEdges, Timer::Elapsed(clk));
@@ -106,8 +124,12 @@ namespace Antipatrea
 
                 query.SetNrNeighbors(GetNrNeighbors());
                 query.SetKey(vid);
-                m_proximityDataStructure.Neighbors(query, res);
+                ApproximateNeighbors(query, res);
+                GenerateEdgesForVertex(vid, res);
+    }
 
+    void PRM::GenerateEdgesForVertex(const int vid, const ProximityResults<int> & res)
+    {
                 const int n = res.GetNrResults();
                 for(int i = 0; i < n; ++i)
                         GenerateEdge(vid, res.GetKey(i), res.GetDistance(i));
@@ -129,10 +151,10 @@ namespace Antipatrea
                 PlannerVertex *v1 = graph->GetVertex(vid1);
                 PlannerVertex *v2 = graph->GetVertex(vid2);
 
-                if(v1->GetConnectionAttempts()->find(vid2) != v1->GetConnectionAttempts()->end())
+                if(v1->HasConnectionAttempt(vid2))
                         return false;
-                v1->GetConnectionAttempts()->insert(vid2);
-                v2->GetConnectionAttempts()->insert(vid1);
+                v1->AddConnectionAttempt(vid2);
+                v2->AddConnectionAttempt(vid1);
 
                 const double tstep = GetOneStepDistance() / d;
                 Cfg         *cfg   = cfgManager->NewCfg();
@@ -163,6 +185,7 @@ namespace Antipatrea
                                 delete edge;
                                 return false;
                         }
+                        cfgManager->StoreCfg(*cfg);
                         edge->GetIntermediateCfgs()->push_back(cfg);
         
                         if (dynamic_cast<CfgAcceptorBasedOnMMC*>(cfgAcceptor))
@@ -189,10 +212,12 @@ namespace Antipatrea
                                 delete edge;
                                 return false;
                         }
+                        cfgManager->StoreCfg(*cfg);
                         edge->GetIntermediateCfgs()->push_back(cfg);
                         cfgOffspringGenerator->SetParentCfg(cfg);
 
-                        connected = cfgDistance->Distance(*cfg, *(v2->GetCfg())) <= GetOneStepDistance();
+                        connected = cfgDistance->ComparableDistance(*cfg, *(v2->GetCfg())) <=
+                            cfgDistance->DistanceToComparable(GetOneStepDistance());
 
                         cfg = cfgManager->NewCfg();
                         }
@@ -209,11 +209,13 @@ namespace Antipatrea
          *
          *@remarks
          *  - While there is time, do:
-         *     - select a vertex from the set of those
-         *       that need to be connected;
-         *     - generate the edges for the selected vertex
-         *       (using GenerateEdgesForVertex);
-         *     - remove the selected vertex from the set of vertices that need to be connected. 
+         *     - select a batch of vertices (at most GetBatchSizeToGenerateVertices()) from the set of those
+         *       that need to be connected and compute their nearest neighbors with one batched query,
+         *       which the proximity data structure distributes among its threads;
+         *     - for each vertex in the batch, generate its edges
+         *       (using GenerateEdgesForVertex) and remove it from the set of vertices that need to be connected. 
+         *  - Since adding edges does not change the proximity data structure, the neighbors are the same
+         *    as when each vertex is queried just before generating its edges.
          *  - Function returns the number of remaining vertices that still
          *    need to be connected.
          */
@@ -228,6 +230,12 @@ namespace Antipatrea
          * - GenerateEdge is used to generate each edge from the vertex to a neighbor.
          */
         virtual void GenerateEdgesForVertex(const int vid);
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Attempt to generate an edge from the vertex to each of the neighbors in <tt>res</tt>.
+         */
+        virtual void GenerateEdgesForVertex(const int vid, const ProximityResults<int> & res);
         
         /**
          *@author Erion Plaku, Amarda Shehu
@@ -7,23 +7,78 @@ namespace Antipatrea
         for(auto & v : m_vertices)
             if(v)
                 delete v;
-        for(auto & iter : m_edges)
-            if(iter.second)
-                delete iter.second;
+        for(auto & e : m_edges)
+            if(e)
+                delete e;
     }
     
-    void PlannerGraph::AddEdge(PlannerEdge * const edge)
+    int PlannerGraph::AddEdge(PlannerEdge * const edge)
     {
-        const int      vidFrom = edge->GetVertexId(PlannerEdge::INDEX_FROM);
-        const int      vidTo   = edge->GetVertexId(PlannerEdge::INDEX_TO);
-        PlannerVertex *vfrom   = GetVertex(vidFrom);
-        PlannerVertex *vto     = GetVertex(vidTo);
+        const int                 vidFrom = edge->GetVertexId(PlannerEdge::INDEX_FROM);
+        const int                 vidTo   = edge->GetVertexId(PlannerEdge::INDEX_TO);
+        const int                 eid     = m_edges.size();
+        PlannerVertex            *vfrom   = GetVertex(vidFrom);
+        PlannerVertex            *vto     = GetVertex(vidTo);
+        PlannerVertex::Connection c;
+
+        // the edge has to go to a new vertex to keep the tree
+        if(IsTree() && (vidFrom == vidTo || m_parents[vidTo] >= 0 || !vto->GetConnections()->empty()))
+            SetTree(false);
         
-        m_edges.insert(std::make_pair(GetEdgeKey(vidFrom, vidTo), edge));
+        m_edges.push_back(edge);
+
+        c.m_vid  = vidTo;
+        c.m_eid  = eid;
+        c.m_cost = edge->GetCost(PlannerEdge::INDEX_FROM_TO);
+        vfrom->GetConnections()->push_back(c);
 
-        vfrom->GetConnections()->insert(vidTo);
-        vto->GetConnections()->insert(vidFrom);
+        c.m_vid  = vidFrom;
+        c.m_cost = edge->GetCost(PlannerEdge::INDEX_TO_FROM);
+        vto->GetConnections()->push_back(c);
         
-        m_components.Join(vfrom->GetDisjointSetElem(), vto->GetDisjointSetElem());
+        if(IsTree())
+        {
+            m_parents[vidTo]     = vidFrom;
+            m_roots[vidTo]       = m_roots[vidFrom];
+            m_parentCosts[vidTo] = edge->GetCost(PlannerEdge::INDEX_FROM_TO);
+            m_pathCosts[vidTo]   = m_pathCosts[vidFrom] + m_parentCosts[vidTo];
+            m_marks[m_roots[vidFrom]] |= m_marks[vidTo];
+            --m_nrRoots;
+        }
+        else
+            m_components.Join(vfrom->GetDisjointSetElem(), vto->GetDisjointSetElem());
+
+        return eid;
+    }
+
+    void PlannerGraph::SetTree(const bool isTree)
+    {
+        if(isTree == IsTree())
+            return;
+
+        if(isTree)
+        {
+            if(GetNrVertices() == 0)
+                m_isTree = true;
+            return;
+        }
+
+        // leave tree mode: build the disjoint set from the edges
+        m_isTree = false;
+        for(auto & v : m_vertices)
+            v->SetDisjointSetElem(m_components.Make());
+        for(auto & e : m_edges)
+            m_components.Join(GetVertex(e->GetVertexId(PlannerEdge::INDEX_FROM))->GetDisjointSetElem(),
+                              GetVertex(e->GetVertexId(PlannerEdge::INDEX_TO))->GetDisjointSetElem());
+        for(int i = 0; i < GetNrVertices(); ++i)
+            if(m_roots[i] == i)
+                m_components.Mark(GetVertex(i)->GetDisjointSetElem(), m_marks[i]);
+
+        m_marks.clear();
+        m_parents.clear();
+        m_roots.clear();
+        m_parentCosts.clear();
+        m_pathCosts.clear();
+        m_nrRoots = 0;
     }
 }
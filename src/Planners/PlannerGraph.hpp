@@ -4,7 +4,6 @@
 #include "Planners/PlannerVertex.hpp"
 #include "Components/Component.hpp"
 #include "Utils/DisjointSet.hpp"
-#include "Utils/HashFn.hpp"
 #include <vector>
 
 namespace Antipatrea
@@ -19,8 +18,9 @@ namespace Antipatrea
      *    - a set of vertices;
      *    - a set of edges; and
      *    - a set of connected components represented as a disjoint set.
-     * - The set of edges is the union of the edges kept by each vertex.
-     *   It is kept as a separate set to facilitate enumeration and searching.
+     * - The edges are kept in a vector, so each edge has a stable integer id, i.e., its position in the vector.
+     *   Each vertex keeps its adjacency (see PlannerVertex::Connection), i.e., the other vertex, the edge id,
+     *   and the cost to go there, so the graph search and enumeration do not need any hashing.
      * - It is assumed that a sampling-based motion planner will
      *   construct an undirected graph, but the edge cost from A to B could
      *   be different from the edge cost from B to A. This could happen, 
@@ -31,14 +31,34 @@ namespace Antipatrea
      *   vertex A to B, it needs to add two edges to the graph, namely,
      *   the edge (A, B) with cost from A to B and the edge (B, A)
      *   with cost from B to A.
+     * - Tree planners only add edges from an existing vertex to a new vertex. For them, the graph can be put
+     *   in tree mode (see SetTree). In this mode, the graph keeps for each vertex the parent id, the cost of the edge
+     *   from the parent, the cost of the path from the root, and the root id in flat arrays, instead of the disjoint set.
+     *   Checking whether two vertices are connected is then a comparison of their roots, and the path from the root
+     *   to a vertex is obtained by following the parents.
+     * - If an edge that does not go to a new vertex is added in tree mode, the graph leaves tree mode and
+     *   builds the disjoint set from the edges that are already in the graph.
+     * - Each connected component has marks (a bit mask, see Mark and GetMarks), which are combined when AddEdge joins
+     *   two components. Planners use them to know right away whether the component of a vertex contains a goal vertex.
      */
     class PlannerGraph : public Component
     {
     public:
-        PlannerGraph(void) : Component()
+        PlannerGraph(void) : Component(),
+                             m_isTree(false),
+                             m_nrRoots(0)
         {
         }
 
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Marks used by the planners (see Mark).
+         */
+        enum Marks
+            {
+                MARK_GOAL = 1
+            };
+
         virtual ~PlannerGraph(void);
 
         /**
@@ -103,10 +123,109 @@ namespace Antipatrea
          */
         virtual int AddVertex(PlannerVertex * const v)
         {
-            v->SetDisjointSetElem(m_components.Make());
+            if(IsTree())
+            {
+                m_parents.push_back(Constants::ID_UNDEFINED);
+                m_roots.push_back(GetNrVertices());
+                m_parentCosts.push_back(0.0);
+                m_pathCosts.push_back(0.0);
+                m_marks.push_back(0);
+                ++m_nrRoots;
+            }
+            else
+                v->SetDisjointSetElem(m_components.Make());
             m_vertices.push_back(v);
             return GetNrVertices() - 1;
         }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return true iff the graph is in tree mode.
+         */
+        virtual bool IsTree(void) const
+        {
+            return m_isTree;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Put the graph in tree mode or take it out of tree mode.
+         *
+         *@remarks
+         * - The graph can be put in tree mode only when it has no vertices.
+         */
+        virtual void SetTree(const bool isTree);
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief In tree mode, get the parent of the vertex (Constants::ID_UNDEFINED for a root).
+         */
+        virtual int GetParent(const int vid) const
+        {
+            return m_parents[vid];
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief In tree mode, get the root of the tree that contains the vertex.
+         */
+        virtual int GetRoot(const int vid) const
+        {
+            return m_roots[vid];
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief In tree mode, get the cost of the edge from the parent to the vertex.
+         */
+        virtual double GetParentCost(const int vid) const
+        {
+            return m_parentCosts[vid];
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief In tree mode, get the cost of the path from the root to the vertex.
+         */
+        virtual double GetPathCost(const int vid) const
+        {
+            return m_pathCosts[vid];
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Get the number of connected components.
+         */
+        virtual int GetNrComponents(void) const
+        {
+            return IsTree() ? m_nrRoots : m_components.GetNrComponents();
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Add the marks to the connected component of the vertex.
+         */
+        virtual void Mark(const int vid, const int marks)
+        {
+            if(IsTree())
+                m_marks[m_roots[vid]] |= marks;
+            else
+                m_components.Mark(GetVertex(vid)->GetDisjointSetElem(), marks);
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Get the marks of the connected component of the vertex.
+         *
+         *@remarks
+         * - It takes constant time in tree mode and a disjoint-set find otherwise.
+         */
+        virtual int GetMarks(const int vid)
+        {
+            if(IsTree())
+                return m_marks[m_roots[vid]];
+            return m_components.GetMarks(GetVertex(vid)->GetDisjointSetElem());
+        }
         
         /**
          *@author Erion Plaku, Amarda Shehu
@@ -119,52 +238,64 @@ namespace Antipatrea
 
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief The key is defined as  <tt>(min(vidFrom, vidTo), max(vidFrom, vidTo))</tt>.
+         *@brief Get a pointer to the edge with id <tt>eid</tt>.
+         *
+         *@remarks
+         * - <tt>eid</tt> should be between <tt>0</tt> and <tt>GetNrEdges()-1</tt>
          */
-        virtual std::pair<int, int> GetEdgeKey(const int vidFrom, const int vidTo) const
+        virtual PlannerEdge* GetEdge(const int eid) const
         {
-            return std::make_pair(std::min(vidFrom, vidTo), std::max(vidFrom, vidTo));
+            return m_edges[eid];
         }
-                
+
         /**
          *@author Erion Plaku, Amarda Shehu
          *@brief Return a pointer to the edge <tt>(vidFrom, vidTo)</tt>.
          *
          *@remarks
          * - If the edge is not in the graph, the function returns <tt>NULL</tt>.
+         * - The function scans the adjacency of the end vertex with fewer connections.
          */
         virtual PlannerEdge* FindEdge(const int vidFrom, const int vidTo) const
         {
-            auto curr = m_edges.find(GetEdgeKey(vidFrom, vidTo));
-            if(curr == m_edges.end())
-                return NULL;
-            else
-                return curr->second;
+            const PlannerVertex *vfrom = GetVertex(vidFrom);
+            const PlannerVertex *vto   = GetVertex(vidTo);
+            const PlannerVertex::Connection *c =
+                vfrom->GetConnections()->size() <= vto->GetConnections()->size() ?
+                vfrom->FindConnection(vidTo) : vto->FindConnection(vidFrom);
+
+            return c ? m_edges[c->m_eid] : NULL;
         }
         
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Add the edge to the graph.
+         *@brief Add the edge to the graph and return its id.
          *
          *@remarks
          * - The function does not check if the edge is already in the graph.
          *   It is the responsibility of the calling function to perform this check (using FindEdge)
          *   if indeed there may be a possibility that the same edge could be added multiple times.
+         * - The edge costs should be set before the edge is added, since they are copied to the
+         *   adjacency of the end vertices.
+         * - In tree mode, the vertex <tt>edge->GetVertexId(PlannerEdge::INDEX_FROM)</tt> becomes the parent
+         *   of the vertex <tt>edge->GetVertexId(PlannerEdge::INDEX_TO)</tt>.
          * - The function also joins the components associated with the end vertices of the edge.
          */
-        virtual void AddEdge(PlannerEdge * const edge);
+        virtual int AddEdge(PlannerEdge * const edge);
 
         /**
          *@author Erion Plaku, Amarda Shehu
          *@brief Return true iff the two vertices are connected by a path.
          *
          *@remarks
-         * - This function uses the disjoint-set data structure, so it works
+         * - This function uses the disjoint-set data structure (or the roots in tree mode), so it works
          *   correctly only if the graph is undirected, i.e.,
          *   if (A, B) is an edge in the graph, then so is (B, A).
          */
         virtual bool AreVerticesPathConnected(const int vidFrom, const int vidTo)
         {
+            if(IsTree())
+                return m_roots[vidFrom] == m_roots[vidTo];
             return m_components.Same(GetVertex(vidFrom)->GetDisjointSetElem(),
                                      GetVertex(vidTo)->GetDisjointSetElem());
         }
@@ -172,6 +303,9 @@ namespace Antipatrea
         /**
          *@author Erion Plaku, Amarda Shehu
          *@brief Get a pointer to the disjoint-set data structure representing the connected components in the graph.
+         *
+         *@remarks
+         * - The disjoint set is not used in tree mode (see GetNrComponents).
          */
         virtual const DisjointSet* GetComponents(void) const
         {
@@ -190,10 +324,10 @@ namespace Antipatrea
 
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Define the data structure (unordered map with the vertex pair as the key) to store
+         *@brief Define the data structure (vector indexed by the edge id) to store
          *       all the edges of the graph.
          */
-        typedef std::unordered_map< std::pair<int, int>, PlannerEdge*, HashStruct< std::pair<int, int> > > Edges;
+        typedef std::vector<PlannerEdge*> Edges;
 
         /**
          *@author Erion Plaku, Amarda Shehu
@@ -232,6 +366,29 @@ namespace Antipatrea
          *@brief Edges of the graph.
          */
         Edges m_edges;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Flag to indicate whether the graph is in tree mode.
+         */
+        bool m_isTree;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief In tree mode, number of trees.
+         */
+        int m_nrRoots;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief In tree mode, parent, root, cost of the edge from the parent, and cost of the path from the root of each vertex,
+         *       and marks of the tree rooted at each vertex (meaningful only for roots).
+         */
+        std::vector<int>    m_marks;
+        std::vector<int>    m_parents;
+        std::vector<int>    m_roots;
+        std::vector<double> m_parentCosts;
+        std::vector<double> m_pathCosts;
     };
 
     /**
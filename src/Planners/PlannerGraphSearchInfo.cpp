@@ -16,14 +16,10 @@ namespace Antipatrea
             return;
         
         auto connections = v->GetConnections();
-        for(auto & vidTo : *connections)
+        for(auto & c : *connections)
         {
-            edges.push_back(vidTo);
-            auto edge = GetPlannerGraph()->FindEdge(vid, vidTo);
-            if(edge->GetVertexId(PlannerEdge::INDEX_FROM) == vid)
-                costs.push_back(edge->GetCost(PlannerEdge::INDEX_FROM));
-            else
-                costs.push_back(edge->GetCost(PlannerEdge::INDEX_TO));
+            edges.push_back(c.m_vid);
+            costs.push_back(c.m_cost);
         }
     }
 }
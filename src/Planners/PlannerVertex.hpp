@@ -5,7 +5,8 @@
 #include "Components/CfgManagers/Cfg.hpp"
 #include "Utils/DisjointSet.hpp"
 #include "Utils/Constants.hpp"
-#include <unordered_set>
+#include <algorithm>
+#include <vector>
 
 namespace Antipatrea
 {        
@@ -19,17 +20,35 @@ namespace Antipatrea
      *    - a configuration;
      *    - a flag to indicate whether or not it is a goal vertex, i.e.,
      *      the associated configuration satisfies the goal;
-     *    - a set of edges;
+     *    - its adjacency, i.e., for each edge, the id of the other vertex, the edge id, and the cost to go there;
      *    - a pointer to a disjoint-set element used to keep track
      *      of the connected components in the planner graph;
      *    - a set of attempts representing the attempts (successful or failed)  the planner
      *      has made to connect this vertex to other vertices.
      * - The vertex deletes the configuration and the disjoint-set element
      *   when it is destructed.
+     * - The adjacency and the attempts are kept in vectors, which are scanned linearly.
+     *   The number of connections per vertex is small (a few neighbors in a roadmap, the children in a tree),
+     *   so this is faster and uses much less memory than hash sets.
      */  
     class PlannerVertex
     {
     public:
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Connection to another vertex.
+         *
+         *@remarks
+         * - <tt>m_cost</tt> is the cost to go from this vertex to <tt>m_vid</tt>, which is copied
+         *   from the edge when the edge is added to the graph.
+         */
+        struct Connection
+        {
+            int    m_vid;
+            int    m_eid;
+            double m_cost;
+        };
+
         PlannerVertex(void) : m_cfg(NULL),
                               m_dsetElem(NULL),
                               m_isGoal(false)
@@ -74,21 +93,33 @@ namespace Antipatrea
         
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Get the ids of the vertices to which it is connected.
+         *@brief Get the connections to other vertices.
          */
-        virtual const std::unordered_set<int>* GetConnections(void) const
+        virtual const std::vector<Connection>* GetConnections(void) const
         {
             return &m_connections;
         }
         
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Get the ids of the vertices to which it is connected.
+         *@brief Get the connections to other vertices.
          */
-        virtual std::unordered_set<int>* GetConnections(void) 
+        virtual std::vector<Connection>* GetConnections(void) 
         {
             return &m_connections;
         }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return the connection to the vertex <tt>vid</tt> (or <tt>NULL</tt> if there is none).
+         */
+        virtual const Connection* FindConnection(const int vid) const
+        {
+            for(auto & c : m_connections)
+                if(c.m_vid == vid)
+                    return &c;
+            return NULL;
+        }
                 
         /**
          *@author Erion Plaku, Amarda Shehu
@@ -124,20 +155,28 @@ namespace Antipatrea
          *@brief Get the attempts (successful or failed)  the planner
          *       has made to connect this vertex to other vertices.
          */
-        virtual const std::unordered_set<int>* GetConnectionAttempts(void) const
+        virtual const std::vector<int>* GetConnectionAttempts(void) const
         {
             return &m_attempts;
         }
 
-                
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Get the attempts (successful or failed)  the planner
-         *       has made to connect this vertex to other vertices.
+         *@brief Return true iff the planner has attempted to connect this vertex to <tt>vid</tt>.
          */
-        virtual std::unordered_set<int>* GetConnectionAttempts(void)
+        virtual bool HasConnectionAttempt(const int vid) const
         {
-            return &m_attempts;
+            return std::find(m_attempts.begin(), m_attempts.end(), vid) != m_attempts.end();
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Record that the planner has attempted to connect this vertex to <tt>vid</tt>.
+         */
+        virtual void AddConnectionAttempt(const int vid)
+        {
+            if(!HasConnectionAttempt(vid))
+                m_attempts.push_back(vid);
         }
 
         
@@ -168,9 +207,9 @@ namespace Antipatrea
         
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Ids of the vertices to which it is connected.
+         *@brief Connections to other vertices.
          */
-        std::unordered_set<int>  m_connections;
+        std::vector<Connection>  m_connections;
 
         /**
          *@author Erion Plaku, Amarda Shehu
@@ -184,7 +223,7 @@ namespace Antipatrea
          *@brief Attempts (successful or failed)  the planner
          *       has made to connect this vertex to other vertices.
          */        
-        std::unordered_set<int> m_attempts;
+        std::vector<int> m_attempts;
                 
         /**
          *@author Erion Plaku, Amarda Shehu
@@ -6,14 +6,17 @@ namespace Antipatrea
 {
     int RRT::SelectVertex(void)
     {
-		ProximityQuery<int> query;
+		ProximityQuery<int>   query;
+		ProximityResults<int> res;
 
-		GetCfgManager()->CopyCfg(*m_proximityAuxCfg, *m_cfgTarget);
-		query.SetKey(Constants::ID_UNDEFINED);
+		query.SetKey(GetProximityQueryKey(*m_cfgTarget));
+		query.SetNrNeighbors(1);
 
 		//return m_proximityDataStructure.Neighbor(query);
 
-		int q =  m_proximityDataStructure.Neighbor(query);
+		ApproximateNeighbors(query, res);
+
+		int q = res.GetNrResults() > 0 ? res.GetKey(0) : query.GetKey();
 		if (m_verbosityFlag == SAMPLING_PLANNER_VERBOSE_FULL)
 			std::cout << "return vertexId:" << q << std::endl;
 
@@ -1,17 +1,22 @@
 #include "Planners/SamplingBasedPlanner.hpp"
 #include "Components/CfgOffspringGenerators/CfgOffspringGeneratorToTarget.hpp"
+#include "Components/CfgDistances/CfgDistanceLp.hpp"
+#include "Components/CfgDistances/SignedDistanceBetweenTwoAngles.hpp"
 #include "Utils/Timer.hpp"
 #include "Utils/Stats.hpp"
+#include <algorithm>
 #include <iostream>
+#include <unordered_map>
 namespace Antipatrea
 {
     void SamplingBasedPlanner::Start(void)
     {
-        m_proximityAuxCfg = GetCfgManager()->NewCfg();
+        SelectProximityDataStructure();
 
+        //clear before AddVertex, which records the initial cfg if it is a goal
+        m_vidsGoal.clear();
         m_vidInit = AddVertex(GetCfgManager()->CopyCfg(*(GetPlannerProblem()->GetInitialCfg())));
 
-        m_vidsGoal.clear();
         // auto cfgGoal = GetPlannerProblem()->GetGoalAcceptor()->GetAnAcceptableCfg();
         // if(cfgGoal != NULL)
         //     AddVertex(GetCfgManager()->CopyCfg(*cfgGoal));
@@ -19,18 +24,41 @@ namespace Antipatrea
     
     bool SamplingBasedPlanner::IsSolved(void)
     {
-        if(m_vidInit < 0)
-            return false;
-
-        for(int i = m_vidsGoal.size() - 1; i >= 0; --i)
-            if(m_vidsGoal[i] >= 0 &&
-              GetPlannerGraph()->AreVerticesPathConnected(m_vidInit, m_vidsGoal[i]))
-                return true;
-        return false;
+        return
+            m_vidInit >= 0 &&
+            (GetPlannerGraph()->GetMarks(m_vidInit) & PlannerGraph::MARK_GOAL) != 0;
     }
     
     bool SamplingBasedPlanner::GetSolution(PlannerSolution & sol)
     {
+        auto graph = GetPlannerGraph();
+
+        if(m_vidInit >= 0 && graph->IsTree() && graph->GetRoot(m_vidInit) == m_vidInit)
+        {
+            int vidGoalFound = Constants::ID_UNDEFINED;
+
+            for(auto & vid : m_vidsGoal)
+                if(vid >= 0 &&
+                   graph->GetRoot(vid) == m_vidInit &&
+                   (vidGoalFound < 0 || graph->GetPathCost(vid) < graph->GetPathCost(vidGoalFound)))
+                    vidGoalFound = vid;
+            if(vidGoalFound >= 0)
+            {
+                auto seq = sol.GetVertexSequence();
+
+                seq->clear();
+                for(int vid = vidGoalFound; vid >= 0; vid = graph->GetParent(vid))
+                    seq->push_back(vid);
+                std::reverse(seq->begin(), seq->end());
+
+                sol.SetCost(graph->GetPathCost(vidGoalFound));
+                FromVertexSequenceToCfgs(sol);
+                return true;
+            }
+            // a vertex could also be marked as goal directly (e.g., the closest vertex when
+            // the planner fails), so fall back to A*, which checks PlannerVertex::IsGoal
+        }
+
         m_graphSearchInfo.SetPlannerGraph(GetPlannerGraph());
         m_graphSearch.SetInfo(&m_graphSearchInfo);
 
@@ -51,30 +79,70 @@ namespace Antipatrea
     {
         const Cfg *cfg1 = vid1 >= 0 ?
             sbPlanner->GetPlannerGraph()->GetVertex(vid1)->GetCfg() :
-            sbPlanner->m_proximityAuxCfg;
+            sbPlanner->m_proximityQueryCfgs[-1 - vid1];
 
         const Cfg *cfg2 = vid2 >= 0 ?
             sbPlanner->GetPlannerGraph()->GetVertex(vid2)->GetCfg() :
-            sbPlanner->m_proximityAuxCfg;
+            sbPlanner->m_proximityQueryCfgs[-1 - vid2];
 
         return sbPlanner->GetCfgDistance()->Distance(*cfg1, *cfg2);
     }
 
+    const double* SamplingBasedPlanner::ProximityValuesFn(const int vid, SamplingBasedPlanner * sbPlanner)
+    {
+        const Cfg *cfg = vid >= 0 ?
+            sbPlanner->GetPlannerGraph()->GetVertex(vid)->GetCfg() :
+            sbPlanner->m_proximityQueryCfgs[-1 - vid];
+
+        return cfg->GetValues();
+    }
+
+    void SamplingBasedPlanner::SelectProximityDataStructure(void)
+    {
+        if(m_proximity->GetKeys()->size() > 0)
+            return;
+
+        if(m_proximityDataStructure.GetNrThreads() > 1 && GetCfgDistance()->IsThreadSafe() == false)
+        {
+            Logger::m_out << "warning SamplingBasedPlanner::SelectProximityDataStructure : " << Name(GetCfgDistance())
+                          << " is not thread safe, so ProximityNrThreads " << m_proximityDataStructure.GetNrThreads()
+                          << " is reduced to 1" << std::endl;
+            m_proximityDataStructure.SetNrThreads(1);
+        }
+
+        CfgDistanceLp *cfgDistanceLp = dynamic_cast<CfgDistanceLp*>(GetCfgDistance());
+
+        if(GetUseProximityTorus() &&
+           cfgDistanceLp != NULL &&
+           cfgDistanceLp->GetExponent() > 0 &&
+           dynamic_cast<SignedDistanceBetweenTwoAngles*>(cfgDistanceLp->GetSignedDistanceBetweenTwoValues()) != NULL)
+        {
+            m_proximityTorus.SetDim(GetCfgManager()->GetDim());
+            m_proximityTorus.SetExponent(cfgDistanceLp->GetExponent());
+            m_proximity = &m_proximityTorus;
+        }
+        else
+            m_proximity = &m_proximityDataStructure;
+    }
+
     int SamplingBasedPlanner::AddVertex(Cfg * const cfgNew)
     {
         PlannerVertex *vnew = NewVertex();
         vnew->SetCfg(cfgNew);
 
+        //pack the values first, so that everything below sees the stored values
+        GetCfgManager()->StoreCfg(*cfgNew);
+        GetCfgDistance()->OnCfgStored(*cfgNew);
+
         const int vidNew = GetPlannerGraph()->AddVertex(vnew);
-        auto goalCfg = GetPlannerProblem()->GetGoalAcceptor()->GetAnAcceptableCfg();
-        double dist = GetCfgDistance()->Distance(*cfgNew,*goalCfg);
 
-        m_proximityDataStructure.AddKey(vidNew);
+        m_proximity->AddKey(vidNew);
 
         if(GetPlannerProblem()->GetGoalAcceptor()->IsAcceptable(*cfgNew))
         {
             m_vidsGoal.push_back(vidNew);
             vnew->MarkAsGoal(true);
+            GetPlannerGraph()->Mark(vidNew, PlannerGraph::MARK_GOAL);
         }
         else
             vnew->MarkAsGoal(false);
@@ -98,13 +166,12 @@ namespace Antipatrea
         auto edges = graph->GetEdges();
 
         out << ne << std::endl;
-        for(auto & iter : *edges)
+        for(auto & edge : *edges)
         {
-            auto edge = iter.second;
             out << edge->GetVertexId(PlannerEdge::INDEX_FROM) << " "
                 << edge->GetVertexId(PlannerEdge::INDEX_TO) << " "
                 << edge->GetCost(PlannerEdge::INDEX_FROM_TO) << " "
-                << edge->GetVertexId(PlannerEdge::INDEX_TO_FROM) << std::endl;
+                << edge->GetCost(PlannerEdge::INDEX_TO_FROM) << std::endl;
 
             auto cfgs = edge->GetIntermediateCfgs();
             out << cfgs->size() << std::endl;
@@ -144,6 +211,10 @@ namespace Antipatrea
             return in;
         }
 
+        // the vertices are indexed all at once after reading them, so a cfg is
+        // checked for duplicates only against the vertices that were already in the graph
+        SelectProximityDataStructure();
+        m_proximity->BeginBulkInsert();
         for(int i = 0; i < nv; ++i)
         {
             cfg = cfgManager->NewCfg();
@@ -151,6 +222,7 @@ namespace Antipatrea
             if(!in.good())
             {
                 Logger::m_out << "error SamplingBasedPlanner::Read : could not read the " << i << "th cfg out of " << nv << " cfgs" << std::endl;
+                m_proximity->EndBulkInsert();
                 return in;
             }
 
@@ -163,6 +235,7 @@ namespace Antipatrea
             if(vid >= 0)
                 map.insert(std::make_pair(i, vid));
         }
+        m_proximity->EndBulkInsert();
 
         if(!(in >> ne))
         {
@@ -209,6 +282,7 @@ namespace Antipatrea
                     delete edge;
                     return in;
                 }
+                cfgManager->StoreCfg(*cfg);
                 edge->GetIntermediateCfgs()->push_back(cfg);
             }
 
@@ -249,12 +323,34 @@ namespace Antipatrea
     int SamplingBasedPlanner::FindCfg(Cfg & cfg)
     {
         ProximityQuery<int> query;
-        query.SetKey(Constants::ID_UNDEFINED);
+        query.SetKey(GetProximityQueryKey(cfg));
         query.SetNrNeighbors(1);
         query.SetRange(Constants::EPSILON);
-        GetCfgManager()->CopyCfg(*m_proximityAuxCfg, cfg);
 
-        return m_proximityDataStructure.Neighbor(query);
+        return m_proximity->Neighbor(query);
+    }
+
+    void SamplingBasedPlanner::ApproximateNeighbors(ProximityQuery<int> & query, ProximityResults<int> & results)
+    {
+        query.SetEpsilon(GetProximityEpsilon());
+        query.SetMaxNrDistanceEvaluations(GetProximityMaxNrDistanceEvaluations());
+        m_proximity->Neighbors(query, results);
+        Stats::GetSingleton()->AddValue(Constants::KW_NrProximityDistanceEvaluations, results.GetNrDistanceEvaluations());
+    }
+
+    void SamplingBasedPlanner::ApproximateNeighbors(const int nrQueries, ProximityQuery<int> queries[], ProximityResults<int> results[])
+    {
+        int nrEvals = 0;
+
+        for(int i = 0; i < nrQueries; ++i)
+        {
+            queries[i].SetEpsilon(GetProximityEpsilon());
+            queries[i].SetMaxNrDistanceEvaluations(GetProximityMaxNrDistanceEvaluations());
+        }
+        m_proximity->Neighbors(nrQueries, queries, results);
+        for(int i = 0; i < nrQueries; ++i)
+            nrEvals += results[i].GetNrDistanceEvaluations();
+        Stats::GetSingleton()->AddValue(Constants::KW_NrProximityDistanceEvaluations, nrEvals);
     }
 
     void SamplingBasedPlanner::FromVertexSequenceToCfgs(PlannerSolution & sol)
@@ -12,7 +12,8 @@
 #include "Components/CfgOffspringGenerators/CfgOffspringGenerator.hpp"
 #include "Components/EdgeCostEvaluators/EdgeCostEvaluator.hpp"
 #include "Utils/ProximityDefault.hpp"
-#include "Utils/GraphSearch.hpp"
+#include "Utils/ProximityTorus.hpp"
+#include "Utils/GraphSearchDense.hpp"
 #include "Setup/Defaults.hpp"
 #include <cmath>
 
@@ -53,18 +54,23 @@ namespace Antipatrea
                                      CfgAcceptorContainer(),
                                      CfgOffspringGeneratorContainer(),
                                      EdgeCostEvaluatorContainer(),
+                                     m_proximityQueryCfgs(1, NULL),
                                      m_vidInit(Constants::ID_UNDEFINED),
                                      m_oneStepDistance(Constants::VAL_SamplingBasedPlanner_OneStepDistance),
-                                     m_proximityAuxCfg(NULL)
+                                     m_proximityEpsilon(Constants::VAL_SamplingBasedPlanner_ProximityEpsilon),
+                                     m_proximityMaxNrDistanceEvaluations(Constants::VAL_SamplingBasedPlanner_ProximityMaxNrDistanceEvaluations),
+                                     m_useProximityTorus(Constants::VAL_SamplingBasedPlanner_ProximityTorus)
         {
             m_proximityDataStructure.m_distFn     = ProximityDistFn;
             m_proximityDataStructure.m_distFnData = this;
+            m_proximityTorus.m_distFn             = ProximityDistFn;
+            m_proximityTorus.m_distFnData         = this;
+            m_proximityTorus.m_valuesFn           = ProximityValuesFn;
+            m_proximity                           = &m_proximityDataStructure;
         }
 
         virtual ~SamplingBasedPlanner(void)
         {
-            if(m_proximityAuxCfg)
-                delete m_proximityAuxCfg;
         }
 
         virtual bool CheckSetup(void)
@@ -99,7 +105,10 @@ namespace Antipatrea
                           << prefix << " CfgAcceptor       = " << Name(GetCfgAcceptor()) << std::endl
                           << prefix << " CfgOffspringGenerator = " << Name(GetCfgOffspringGenerator()) << std::endl
                           << prefix << " EdgeCostEvaluator = " << Name(GetEdgeCostEvaluator()) << std::endl
-                          << prefix << " OneStepDistance   = " << GetOneStepDistance() << std::endl;
+                          << prefix << " OneStepDistance   = " << GetOneStepDistance() << std::endl
+                          << prefix << " ProximityEpsilon  = " << GetProximityEpsilon() << std::endl
+                          << prefix << " ProximityMaxNrDistanceEvaluations = " << GetProximityMaxNrDistanceEvaluations() << std::endl
+                          << prefix << " ProximityTorus    = " << GetUseProximityTorus() << std::endl;
         }
         
         /**
@@ -111,9 +120,17 @@ namespace Antipatrea
          * - It then sets the one-step distance (keyword Constants::KW_OneStepDistance), which
          *   is used by sampling-based planners to determine the resolution at which to discretize
          *   paths (e.g., PRM-like planners) or to determine the step when expanding a branch (e.g., tree-based planners).
+         * - It also sets the number of threads used to build the proximity data structure
+         *   (keyword Constants::KW_ProximityNrThreads). If the configuration distance is not
+         *   safe to call concurrently (see CfgDistance::IsThreadSafe), Start uses one thread instead.
+         * - It also sets the approximation factor and the maximum number of distance evaluations
+         *   of the nearest-neighbors queries used to expand the planner
+         *   (keywords Constants::KW_ProximityEpsilon, Constants::KW_ProximityMaxNrDistanceEvaluations).
+         * - It also sets whether to use ProximityTorus when the distance is an Lp norm over angles
+         *   (keyword Constants::KW_ProximityTorus).
          * - It uses the parameter group associated with the keyword Constants::KW_SamplingBasedPlanner.
          * - The parameter value can be specified in a text file as, for example,
-         *     <center><tt>SamplingBasedPlanner { OneStepDistance 0.01 }</tt></center>
+         *     <center><tt>SamplingBasedPlanner { OneStepDistance 0.01 ProximityNrThreads 4 }</tt></center>
          */
         virtual void SetupFromParams(Params & params)
         {
@@ -123,6 +140,12 @@ namespace Antipatrea
             if(data && data->m_params)
             {
                 SetOneStepDistance(data->m_params->GetValueAsDouble(Constants::KW_OneStepDistance, GetOneStepDistance()));
+                m_proximityDataStructure.SetNrThreads(data->m_params->GetValueAsInt(Constants::KW_ProximityNrThreads,
+                                                                                     m_proximityDataStructure.GetNrThreads()));
+                SetProximityEpsilon(data->m_params->GetValueAsDouble(Constants::KW_ProximityEpsilon, GetProximityEpsilon()));
+                SetProximityMaxNrDistanceEvaluations(data->m_params->GetValueAsInt(Constants::KW_ProximityMaxNrDistanceEvaluations,
+                                                                                   GetProximityMaxNrDistanceEvaluations()));
+                SetUseProximityTorus(data->m_params->GetValueAsBool(Constants::KW_ProximityTorus, GetUseProximityTorus()));
             }
             
         }
@@ -153,6 +176,67 @@ namespace Antipatrea
             m_oneStepDistance = d;
         }
 
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Get the approximation factor of the nearest-neighbors queries used to expand the planner.
+         *
+         *@remarks
+         * - With <tt>epsilon > 0</tt>, a query may return a neighbor up to <tt>1 + epsilon</tt> times
+         *   farther than the nearest one, in exchange for fewer distance evaluations.
+         * - Queries that need exact answers, such as FindCfg, do not use it.
+         */
+        virtual double GetProximityEpsilon(void) const
+        {
+            return m_proximityEpsilon;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Set the approximation factor of the nearest-neighbors queries used to expand the planner.
+         */
+        virtual void SetProximityEpsilon(const double epsilon)
+        {
+            m_proximityEpsilon = epsilon;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Get the maximum number of distance evaluations of the nearest-neighbors queries used to
+         *       expand the planner, after which a query returns the best neighbors found so far.
+         */
+        virtual int GetProximityMaxNrDistanceEvaluations(void) const
+        {
+            return m_proximityMaxNrDistanceEvaluations;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Set the maximum number of distance evaluations of the nearest-neighbors queries used to expand the planner.
+         */
+        virtual void SetProximityMaxNrDistanceEvaluations(const int n)
+        {
+            m_proximityMaxNrDistanceEvaluations = n;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return true iff ProximityTorus is used instead of the default proximity data structure
+         *       when the configuration distance allows it (see SelectProximityDataStructure).
+         */
+        virtual bool GetUseProximityTorus(void) const
+        {
+            return m_useProximityTorus;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Set whether to use ProximityTorus when the configuration distance allows it.
+         */
+        virtual void SetUseProximityTorus(const bool use)
+        {
+            m_useProximityTorus = use;
+        }
+
         
         
         /**
@@ -172,8 +256,8 @@ namespace Antipatrea
          *@brief Return true iff the planner has found a solution.
          *
          *@remarks
-         * - The function uses the disjoint-set data structure to check whether any vertex that is marked as goal
-         *   belongs to the same connected component as the initial vertex.
+         * - Goal vertices mark their component with PlannerGraph::MARK_GOAL, and the marks are combined as edges join components,
+         *   so the function only checks the marks of the component of the initial vertex.
          */
         virtual bool IsSolved(void);
 
@@ -186,6 +270,8 @@ namespace Antipatrea
          * - If a solution is found, A* is used to find the shortest path in the planner graph.
          *   The solution is constructed based on the vertex ids of this shortest path
          *   and the corresponding configurations. 
+         * - When the planner graph is in tree mode and the initial vertex is the root, the path is unique,
+         *   so the function selects the goal vertex with the lowest path cost and follows the parents instead.
          */        
         virtual bool GetSolution(PlannerSolution & sol);
 
@@ -296,12 +382,94 @@ namespace Antipatrea
          */
         static double ProximityDistFn(const int vid1, const int vid2, SamplingBasedPlanner * sbPlanner);
 
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return the values of the configuration of the vertex (or query slot) <tt>vid</tt>,
+         *       which ProximityTorus uses instead of the distance function.
+         */
+        static const double* ProximityValuesFn(const int vid, SamplingBasedPlanner * sbPlanner);
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Select the proximity data structure used for the nearest-neighbors queries.
+         *
+         *@remarks
+         * - ProximityTorus is selected when GetUseProximityTorus() is true and the configuration distance
+         *   is CfgDistanceLp with SignedDistanceBetweenTwoAngles and a positive exponent, i.e., the configuration
+         *   space is a torus; otherwise, the default proximity data structure (GNAT) is selected.
+         * - The selection is made only while the proximity data structure is empty.
+         * - The default proximity data structure is limited to one thread, with a warning, if the
+         *   configuration distance is not safe to call concurrently (see CfgDistance::IsThreadSafe).
+         */
+        virtual void SelectProximityDataStructure(void);
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return the key that the proximity data structure uses for the query configuration <tt>cfg</tt>.
+         *
+         *@remarks
+         * - Keys <tt>-1, -2, ...</tt> refer to the configurations of the query slots <tt>0, 1, ...</tt>,
+         *   while nonnegative keys refer to the vertices of the graph.
+         * - Only a pointer to <tt>cfg</tt> is kept, so <tt>cfg</tt> should remain valid during the query.
+         * - Threads that query the proximity data structure concurrently should use different slots
+         *   (see SetNrProximityQuerySlots).
+         */
+        virtual int GetProximityQueryKey(const Cfg & cfg, const int slot = 0)
+        {
+            m_proximityQueryCfgs[slot] = &cfg;
+            return -1 - slot;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Set the number of query slots (see GetProximityQueryKey).
+         */
+        virtual void SetNrProximityQuerySlots(const int n)
+        {
+            m_proximityQueryCfgs.resize(n, NULL);
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Compute the neighbors of the query in the approximate mode of the planner
+         *       (see SetProximityEpsilon and SetProximityMaxNrDistanceEvaluations).
+         *
+         *@remarks
+         * - The number of distance evaluations is added to the statistic
+         *   Constants::KW_NrProximityDistanceEvaluations.
+         */
+        virtual void ApproximateNeighbors(ProximityQuery<int> & query, ProximityResults<int> & results);
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Same as ApproximateNeighbors(query, results), but for a batch of <tt>nrQueries</tt> queries
+         *       whose keys are vertex ids (query slots are not shared among threads).
+         *
+         *@remarks
+         * - The batch is distributed among the threads of the proximity data structure
+         *   (keyword Constants::KW_ProximityNrThreads), which is one thread unless
+         *   the configuration distance is safe to call concurrently (see SelectProximityDataStructure).
+         */
+        virtual void ApproximateNeighbors(const int nrQueries, ProximityQuery<int> queries[], ProximityResults<int> results[]);
+
         /**
          *@author Erion Plaku, Amarda Shehu
          *@brief Proximity data structure to facilitate nearest-neighbors queires.
          */        
         ProximityDefault<int, SamplingBasedPlanner*>  m_proximityDataStructure;
 
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Proximity data structure specialized for configuration spaces that are a torus.
+         */
+        ProximityTorus<int, SamplingBasedPlanner*>    m_proximityTorus;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Proximity data structure used for the queries (see SelectProximityDataStructure).
+         */
+        Proximity<int, SamplingBasedPlanner*>        *m_proximity;
+
         /**
          *@author Erion Plaku, Amarda Shehu
          *@brief verbosity flag
@@ -310,10 +478,10 @@ namespace Antipatrea
 
         /**
          *@author Erion Plaku, Amarda Shehu
-         *@brief Auxilary configuration used by the proximity data structure to 
-         *       compute nearest-neighbors queries.
+         *@brief Query configurations used by the proximity data structure to 
+         *       compute nearest-neighbors queries, one per query slot.
          */
-        Cfg *m_proximityAuxCfg;
+        std::vector<const Cfg*> m_proximityQueryCfgs;
 
         /**
          *@author Erion Plaku, Amarda Shehu
@@ -331,7 +499,7 @@ namespace Antipatrea
          *@author Erion Plaku, Amarda Shehu
          *@brief Graph-searching algorithms, e.g., DFS, BFS, A*, Dijkstra.
          */
-        GraphSearch<int> m_graphSearch;
+        GraphSearchDense m_graphSearch;
                 
         /**
          *@author Erion Plaku, Amarda Shehu
@@ -346,6 +514,20 @@ namespace Antipatrea
          */
         double m_oneStepDistance;
 
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Approximation factor and maximum number of distance evaluations of the
+         *       nearest-neighbors queries used to expand the planner.
+         */
+        double m_proximityEpsilon;
+        int    m_proximityMaxNrDistanceEvaluations;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Flag to use ProximityTorus when the configuration distance allows it.
+         */
+        bool   m_useProximityTorus;
+
     };
     
     /**
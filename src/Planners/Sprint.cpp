@@ -22,11 +22,7 @@ namespace Antipatrea
 		  r.m_weightId = i+1;
 		  r.SetPower(m_regionExp);
 
-		  auto regionNode = m_selector.Create();
-		  regionNode->SetKey(i);
-		  regionNode->SetWeight(0.0);
-          m_selector.Insert(regionNode);
-          r.nodePtr = regionNode;
+		  r.m_slot = m_selector.Insert(i, 0.0);
 
 	  }
   }
@@ -52,7 +48,6 @@ int Sprint::AddVertex(Cfg * const cfg)
         }
 
         DeltaRRegion &region = m_regions[regionID];
-        auto regionNode = region.nodePtr;
         int vid = -1;
 		vid = TreeSamplingBasedPlanner::AddVertex(cfg);
 		if (vid >= 0)
@@ -60,7 +55,7 @@ int Sprint::AddVertex(Cfg * const cfg)
 			auto newVertex = dynamic_cast<SprintVertex*>(graph->GetVertex(vid));
 			region.AddVertex(vid);
 
-			m_selector.Update(regionNode,region.GetWeight());
+			m_selector.Update(region.m_slot,region.GetWeight());
 		}
 		projector->DeleteValues(projection);
         return (vid);
@@ -69,9 +64,7 @@ int Sprint::AddVertex(Cfg * const cfg)
 
     int Sprint::SelectVertex(void)
     {
-        auto regionNode = m_selector.Select();
-
-        auto regionIndex = regionNode->GetKey();
+        auto regionIndex = m_selector.GetKey(m_selector.Select());
 
         if (m_verbosityFlag == SAMPLING_PLANNER_VERBOSE_LOW)
         {
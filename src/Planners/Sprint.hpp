@@ -13,7 +13,7 @@
 #include "Setup/Defaults.hpp"
 #include "Utils/Grid.hpp"
 #include "PluginRosetta/CfgProjectorDeltaR.hpp"
-#include <Utils/Selector.hpp>
+#include <Utils/SelectorArray.hpp>
 
 namespace Antipatrea
 {
@@ -46,22 +46,17 @@ namespace Antipatrea
 
     	void AddVertex(int vid)
     	{
-    		auto newNode = m_selector.Create();
-			newNode->SetKey(vid);
-			newNode->SetWeight(1.0);
-
-			m_selector.Insert(newNode);
+    		m_selector.Insert(vid, 1.0);
     	}
 
     	int SelectVertex()
     	{
-    		auto cell = m_selector.Select();
-    		return (cell->GetKey());
+    		return (m_selector.GetKey(m_selector.Select()));
     	}
 
     	double GetWeight()
     	{
-    		if (m_selector.GetNrNodes() == 1) // *first node added
+    		if (m_selector.GetNrItems() == 1) // *first node added
     		{
     			m_weight = pow(m_weightId,m_power);
     		}
@@ -72,7 +67,7 @@ namespace Antipatrea
 
     	unsigned int GetNrConfs()
     	{
-    		return (m_selector.GetNrNodes());
+    		return (m_selector.GetNrItems());
     	}
 
     	void SetPower(unsigned int p)
@@ -80,11 +75,11 @@ namespace Antipatrea
     		m_power = p;
     	}
 
-    	Selector<unsigned int>::Node *nodePtr;
+    	int m_slot;
     	int m_weightId;
     	int m_power;
     protected:
-        Selector<int> m_selector;
+        SelectorArray<int> m_selector;
         double m_weight;
 
     };
@@ -223,7 +218,7 @@ namespace Antipatrea
           */
 
         std::vector<DeltaRRegion> m_regions;
-        Selector<unsigned int> m_selector;
+        SelectorArray<unsigned int> m_selector;
         int m_regionExp;
        };
 }
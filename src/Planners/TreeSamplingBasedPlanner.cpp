@@ -16,6 +16,9 @@ namespace Antipatrea
         if(m_cfgTarget == NULL)
                 m_cfgTarget = GetCfgManager()->NewCfg();
 
+        // edges only go from a vertex in the tree to a new vertex
+        GetPlannerGraph()->SetTree(true);
+
         SamplingBasedPlanner::Start();
 
         /*
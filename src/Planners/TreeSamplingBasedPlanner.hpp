@@ -172,6 +172,9 @@ namespace Antipatrea
         /**
          *@author Erion Plaku, Amarda Shehu
          *@brief Root the tree at the initial configuration.
+         *
+         *@remarks
+         * - The planner graph is put in tree mode (see PlannerGraph::SetTree) if it is empty.
          */
         virtual void Start(void);
         
@@ -12,7 +12,7 @@ namespace Antipatrea
         double     p2[2];
         
         
-        chain->CopyJointValues(cfg.GetValues());
+        chain->CopyJointValues(static_cast<const Cfg &>(cfg).GetValues());
         chain->FK();
 
         //self-collision
@@ -49,7 +49,7 @@ namespace Antipatrea
          */        
         virtual bool IsAcceptable(Cfg & cfg)
         {
-            return GetScene2D()->IsPointInCollision(cfg.GetValues()) == false;
+            return GetScene2D()->IsPointInCollision(static_cast<const Cfg &>(cfg).GetValues()) == false;
         }
     };
 
@@ -24,7 +24,7 @@ namespace Antipatrea
 
         virtual void DrawCfg(Cfg & cfg)
         {
-            dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->CopyJointValues(cfg.GetValues());
+            dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->CopyJointValues(static_cast<const Cfg &>(cfg).GetValues());
             dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->FK();
             dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->Draw();
         }
@@ -33,13 +33,13 @@ namespace Antipatrea
         {
             const int n = dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->GetNrLinks();
             
-            dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->CopyJointValues(cfg1.GetValues());
+            dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->CopyJointValues(static_cast<const Cfg &>(cfg1).GetValues());
             dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->FK();
             
             const double x1 = dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->GetLinkEndX(n-1);
             const double y1 = dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->GetLinkEndY(n-1);
             
-            dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->CopyJointValues(cfg2.GetValues());
+            dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->CopyJointValues(static_cast<const Cfg &>(cfg2).GetValues());
             dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->FK();
             
             const double x2 = dynamic_cast<SetupChain2D*>(m_setup)->GetChain2D()->GetLinkEndX(n-1);
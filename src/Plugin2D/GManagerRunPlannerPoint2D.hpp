@@ -24,12 +24,12 @@ namespace Antipatrea
         
         virtual void DrawCfg(Cfg & cfg)
         {
-            GDrawCircle2D(cfg.GetValues(), 0.2);
+            GDrawCircle2D(static_cast<const Cfg &>(cfg).GetValues(), 0.2);
         }
 
         virtual void DrawEdge(Cfg & cfg1, Cfg & cfg2)
         {
-            GDrawSegment2D(cfg1.GetValues(), cfg2.GetValues());
+            GDrawSegment2D(static_cast<const Cfg &>(cfg1).GetValues(), static_cast<const Cfg &>(cfg2).GetValues());
         }
     };
 }
@@ -16,6 +16,15 @@ namespace Antipatrea
      *@remarks
      *  - Distance is computed as the normalized sum of the square of the differences in each atom's position.
      *  - It requires access to CfgManager to access the configuration dimension.
+     *  - The least RMSD is computed with the QCP method (see Utils/Superposition.hpp).
+     *  - The centered backbone coordinates of a configuration stored in a planner vertex are
+     *    computed once (see OnCfgStored) and cached with the configuration, so forward kinematics
+     *    is not rerun on every distance computation.
+     *  - The cache takes 9 doubles per residue, which is more than the configuration values
+     *    (see SetCacheCoords for when it is used).
+     *  - The scratch buffers used for uncached configurations are per thread, so the distance
+     *    can be called concurrently when the backbone coordinates are computed without Rosetta
+     *    (see IsThreadSafe).
      */
 
     class CfgDistanceAtomRMSD : public CfgDistance,
@@ -24,7 +33,8 @@ namespace Antipatrea
     {
     public:
         CfgDistanceAtomRMSD(void) : CfgDistance(),
-                                    CfgManagerContainer()
+                                    CfgManagerContainer(),
+                                    m_cacheCoords(CACHE_AUTO)
         {
             distCalcs = 0;
         }
@@ -55,10 +65,57 @@ namespace Antipatrea
          *
          *@remarks
          * - Function first invokes CfgDistance::SetupFromParams(params).
+         * - It then sets when the coordinates are cached (keyword Constants::KW_CacheCoords, with values
+         *   Constants::VAL_CfgDistanceAtomRMSD_CacheAuto, Constants::VAL_CfgDistanceAtomRMSD_CacheAlways,
+         *   Constants::VAL_CfgDistanceAtomRMSD_CacheNever).
+         * - It uses the parameter group associated with the keyword Constants::KW_CfgDistanceAtomRMSD.
+         * - The parameter value can be specified in a text file as, for example,
+         *     <center><tt>CfgDistanceAtomRMSD { CacheCoords Never }</tt></center>
          */
         virtual void SetupFromParams(Params & params)
         {
             CfgDistance::SetupFromParams(params);
+
+            auto data = params.GetData(Constants::KW_CfgDistanceAtomRMSD);
+            if(data && data->m_params)
+            {
+                auto cache = data->m_params->GetValue(Constants::KW_CacheCoords);
+                if(StrSameContent(cache, Constants::VAL_CfgDistanceAtomRMSD_CacheAlways))
+                    SetCacheCoords(CACHE_ALWAYS);
+                else if(StrSameContent(cache, Constants::VAL_CfgDistanceAtomRMSD_CacheNever))
+                    SetCacheCoords(CACHE_NEVER);
+                else if(StrSameContent(cache, Constants::VAL_CfgDistanceAtomRMSD_CacheAuto))
+                    SetCacheCoords(CACHE_AUTO);
+            }
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief When OnCfgStored caches the coordinates with the configuration.
+         *
+         *@remarks
+         * - CACHE_ALWAYS: the coordinates are always cached.
+         * - CACHE_NEVER: the coordinates are never cached, so they are recomputed (forward kinematics)
+         *   whenever a distance is computed.
+         * - CACHE_AUTO (default): the coordinates are cached only when CfgManager keeps the values
+         *   as doubles (CfgManager::STORAGE_DOUBLE). Packed storage is chosen to save memory,
+         *   and the cache would take most of it.
+         */
+        enum CacheCoords
+            {
+                CACHE_AUTO,
+                CACHE_ALWAYS,
+                CACHE_NEVER
+            };
+
+        virtual CacheCoords GetCacheCoords(void) const
+        {
+            return m_cacheCoords;
+        }
+
+        virtual void SetCacheCoords(const CacheCoords cacheCoords)
+        {
+            m_cacheCoords = cacheCoords;
         }
 
         
@@ -73,7 +130,132 @@ namespace Antipatrea
 
         virtual double DistancePrint(const Cfg & cfg1,
                                      const Cfg & cfg2);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Computes the least RMSD between <tt>cfg</tt> and each of the configurations <tt>cfgs[0], ..., cfgs[m - 1]</tt>.
+         *
+         *@remarks
+         * - When the coordinates of all <tt>cfgs</tt> are cached, the RMSDs are computed
+         *   in a single batched pass (see Superposition::QCPRMSDs).
+         */
+        virtual void Distances(const Cfg & cfg,
+                               const int m,
+                               const Cfg * const cfgs[],
+                               double dists[]);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Return the radius of gyration of the backbone atoms.
+         *
+         *@remarks
+         * - For centered coordinates <tt>X</tt> and <tt>Y</tt> and any rotation <tt>R</tt>,
+         *   <tt>||X - RY|| >= | ||X|| - ||Y|| |</tt>, so the difference between the radii of gyration
+         *   is a lower bound on the least RMSD.
+         * - It uses the inner product stored with the centered coordinates, so it costs one square root
+         *   when the coordinates are cached.
+         */
+        virtual double LowerBoundKey(const Cfg & cfg);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Return true iff the backbone coordinates are computed by CfgForwardKinematicsBackbone
+         *       (see MolecularStructureRosetta::UseNativeBackboneFK).
+         *
+         *@remarks
+         * - Otherwise, the coordinates of uncached configurations are obtained from the single Rosetta pose,
+         *   which cannot be shared among threads.
+         */
+        virtual bool IsThreadSafe(void) const
+        {
+            return GetMolecularStructureRosetta() != NULL && GetMolecularStructureRosetta()->UseNativeBackboneFK();
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Compute the centered backbone coordinates of the configuration and cache them with it.
+         */
+        virtual void OnCfgStored(Cfg & cfg);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Return the number of coordinate values (3 per backbone atom).
+         */
+        virtual int GetNrCoords(void) const;
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Compute the backbone coordinates of the configuration and center them at the origin.
+         *
+         *@remarks
+         * - The coordinates are stored as all x values, then all y values, then all z values,
+         *   followed by their inner product, as expected by Superposition::QCPRMSD.
+         * - <tt>coords</tt> should have room for GetNrCoords() + 1 values.
+         */
+        virtual void ComputeCoords(const Cfg & cfg, double coords[]);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Same as ComputeCoords, but starting from already computed backbone coordinates
+         *       <tt>atomPositions</tt> (x0 y0 z0 x1 y1 z1 ..., as given by MolecularStructureRosetta::GetBackboneCoords).
+         */
+        virtual void ComputeCoordsFromBackbone(const double atomPositions[], double coords[]) const;
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Return the centered backbone coordinates of the configuration.
+         *
+         *@remarks
+         * - If the coordinates are cached with the configuration, they are returned directly.
+         * - Otherwise, they are computed into one of the scratch buffers of the calling thread, unless
+         *   a scratch buffer already holds the coordinates for the same configuration values, e.g., when the same
+         *   query configuration is compared against many vertices.
+         * - The coordinates of an uncached configuration remain valid only until the next two lookups
+         *   by the same thread.
+         */
+        const double* GetCoords(const Cfg & cfg);
+
     protected:
+        enum
+            {
+                NR_SCRATCH = 2
+            };
+
+        struct Scratch
+        {
+            std::vector<double> m_vals;
+            std::vector<double> m_coords;
+        };
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Buffers used by one thread to compute distances.
+         */
+        struct Workspace
+        {
+            Workspace(void) : m_owner(NULL),
+                              m_scratchNext(0)
+            {
+            }
+
+            const CfgDistanceAtomRMSD  *m_owner;
+            Scratch                     m_scratch[NR_SCRATCH];
+            int                         m_scratchNext;
+            std::vector<double>         m_atomPositions;
+            std::vector<const double *> m_batchCoords;
+            std::vector<double>         m_batchInnerProducts;
+        };
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Get the workspace of the calling thread.
+         *
+         *@remarks
+         * - Its scratch coordinates are discarded when it was last used by another instance.
+         */
+        Workspace& GetThreadWorkspace(void) const;
+
+        CacheCoords  m_cacheCoords;
         unsigned int distCalcs;
     };
 
@@ -4,6 +4,7 @@
 #include <fstream>
 #include "Utils/PseudoRandom.hpp"
 #include "Utils/Algebra2D.hpp"
+#include "Utils/Superposition.hpp"
 
 namespace Antipatrea
 {
@@ -21,6 +22,14 @@ namespace Antipatrea
         	m_distanceTol =
         			data->m_params->GetValueAsInt(Constants::KW_OffspringRosetta_DistanceTol,
         			        	    		      Constants::VAL_OffspringRosetta_DistanceTol);
+
+        	m_incrementalFK =
+        			data->m_params->GetValueAsBool(Constants::KW_OffspringRosetta_IncrementalFK,
+        			                               m_incrementalFK);
+
+        	m_nrThreads =
+        			data->m_params->GetValueAsInt(Constants::KW_OffspringRosetta_NrThreads,
+        			                              m_nrThreads);
         	auto dataFragment
 				= data->m_params->GetData(Constants::KW_OffspringRosetta_FragmentFiles);
         	if(dataFragment && dataFragment->m_values.size() > 0) {
@@ -47,26 +56,18 @@ namespace Antipatrea
         {
             unsigned int fragmentSize =
             		LoadFragmentLibrary(m_fragmentFileNames[i],m_fragmentProbs[i]);
-            auto fragmentNode = m_selector.Create();
-            fragmentNode->SetKey(fragmentSize);
-            fragmentNode->SetWeight(m_fragmentProbs[i]);
-            m_selector.Insert(fragmentNode);
+            m_selector.Insert(fragmentSize, m_fragmentProbs[i]);
         }
+        m_selector.Build();
         PrintSummary();
     }
 
     // Generate an offspring using Rosetta that is "close" to the target
     // structure specified.
 
-    double CfgOffspringGeneratorRosetta::GenerateAnOffspringCfg(Cfg & cfg)
+    void CfgOffspringGeneratorRosetta::SampleCandidate(Candidate & candidate)
     {
-        auto cfgManager = GetCfgManager();
-        auto mol        = GetMolecularStructureRosetta();
-        const int dim   = cfgManager->GetDim(); //number of configuration dimensions;
-        double *vals    = cfg.GetValues();      //values of the configuration
-
-        auto fragmentNode = m_selector.Select();
-        int fragmentSize = fragmentNode->GetKey();
+        int fragmentSize = m_selector.GetKey(m_selector.Select());
 
         if (m_verboseFlag)
         {
@@ -75,8 +76,10 @@ namespace Antipatrea
 
         auto &db = m_fragmentMap[fragmentSize];
 
-        auto sampleAAPosition = RandomUniformInteger(0,db.NumberOfPositions() - 1);
-        auto fragmentIndex    = RandomUniformInteger(0,db.NumberOfSamples(sampleAAPosition)-1);
+        unsigned int sampleAAPosition;
+        unsigned int fragmentIndex;
+
+        db.Sample(sampleAAPosition, fragmentIndex);
 
         if (m_verboseFlag)
         {
@@ -84,48 +87,154 @@ namespace Antipatrea
         			<< " maxposition:" << db.NumberOfPositions() - 1 << std::endl;
         }
 
-        /*
-                  << ":1phi:" << db.GetFragmentPhi(sampleAAPosition,fragmentIndex,0)
-                  << ":1phideg:" << Algebra2D::RadiansToDegrees(db.GetFragmentPhi(sampleAAPosition,fragmentIndex,0))
-                  << ":1psi:" << db.GetFragmentPsi(sampleAAPosition,fragmentIndex,0)
-                  << ":1omg:" << db.GetFragmentOmega(sampleAAPosition,fragmentIndex,0)
-                  << ":2phi:" << db.GetFragmentPhi(sampleAAPosition,fragmentIndex,1)
-                  << ":2phideg:" << Algebra2D::RadiansToDegrees(db.GetFragmentPhi(sampleAAPosition,fragmentIndex,1))
-                  << ":2psi:" << db.GetFragmentPsi(sampleAAPosition,fragmentIndex,1)
-                  << ":2omg:" << db.GetFragmentOmega(sampleAAPosition,fragmentIndex,1)
-                  << ":3phi:" << db.GetFragmentPhi(sampleAAPosition,fragmentIndex,2)
-                  << ":3phideg:" << Algebra2D::RadiansToDegrees(db.GetFragmentPhi(sampleAAPosition,fragmentIndex,2))
-                  << ":3psi:" << db.GetFragmentPsi(sampleAAPosition,fragmentIndex,2)
-                  << ":3omg:" << db.GetFragmentOmega(sampleAAPosition,fragmentIndex,2)  << "\n"; */
-
-        auto pCfg =  GetParentCfg();
-        auto pCfgVals = pCfg->GetValues();
-        memcpy(vals,pCfgVals,sizeof(double)*dim);
-
-
-        for (auto i=0; i < fragmentSize;++i)
+        candidate.m_fragmentSize  = fragmentSize;
+        candidate.m_position      = sampleAAPosition;
+        candidate.m_fragmentIndex = fragmentIndex;
+    }
+
+    void CfgOffspringGeneratorRosetta::ApplyCandidate(const Candidate & candidate, double vals[])
+    {
+        const int dim         = GetCfgManager()->GetDim();
+        auto      &db         = m_fragmentMap.find(candidate.m_fragmentSize)->second;
+        const int position    = candidate.m_position;
+        const int index       = candidate.m_fragmentIndex;
+
+        memcpy(vals, GetParentCfg()->GetValues(), sizeof(double) * dim);
+
+        for (auto i=0; i < candidate.m_fragmentSize;++i)
         {
-            vals[3*(sampleAAPosition+i) + 0] = db.GetFragmentPhi(sampleAAPosition,fragmentIndex,i);
-            vals[3*(sampleAAPosition+i) + 1] = db.GetFragmentPsi(sampleAAPosition,fragmentIndex,i);
-            vals[3*(sampleAAPosition+i) + 2] = db.GetFragmentOmega(sampleAAPosition,fragmentIndex,i);
-
-    /*      std::cout << "Plugging in angles phi:" <<  db.GetFragmentPhi(sampleAAPosition,fragmentIndex,i)
-                      << " psi:" <<  db.GetFragmentPsi(sampleAAPosition,fragmentIndex,i)
-                     << " omg:" <<  db.GetFragmentOmega(sampleAAPosition,fragmentIndex,i) << std::endl;
-    */
+            vals[3*(position+i) + 0] = db.GetFragmentPhi(position,index,i);
+            vals[3*(position+i) + 1] = db.GetFragmentPsi(position,index,i);
+            vals[3*(position+i) + 2] = db.GetFragmentOmega(position,index,i);
         }
+    }
+
+    // Generate an offspring using Rosetta that is "close" to the target
+    // structure specified.
+
+    double CfgOffspringGeneratorRosetta::GenerateAnOffspringCfg(Cfg & cfg)
+    {
+        double   *vals = cfg.GetValues();      //values of the configuration
+        Candidate candidate;
+
+        SampleCandidate(candidate);
+        ApplyCandidate(candidate, vals);
 
         cfg.SetValues(vals); //KMDEBUG Don't think this is necessary since the ptr to the double array has not changed
 
+        if (m_useIncrementalFK)
+            ComputeOffspringCoords(cfg, candidate.m_position, candidate.m_position + candidate.m_fragmentSize);
+
         auto d = GetCfgDistance();
         double dist = d->Distance(*m_cfgTarget,cfg);
         return (dist);
     }
 
+    void CfgOffspringGeneratorRosetta::ComputeOffspringCoords(Cfg & cfg, const int start, const int end)
+    {
+        auto rmsd = dynamic_cast<CfgDistanceAtomRMSD*>(GetCfgDistance());
+        auto mol  = GetMolecularStructureRosetta();
+
+        m_offspringAtoms.resize(m_parentAtoms.size());
+        mol->GetNativeBackbone()->UpdateBackboneCoords(cfg, start, end, &m_parentAtoms[0], &m_offspringAtoms[0]);
+
+        double *coords = new double[rmsd->GetNrCoords() + 1];
+
+        rmsd->ComputeCoordsFromBackbone(&m_offspringAtoms[0], coords);
+        cfg.SetCoords(coords);
+    }
+
+    void CfgOffspringGeneratorRosetta::GenerateOffspringCfgInParallel(Cfg & cfg)
+    {
+        auto       rmsd  = dynamic_cast<CfgDistanceAtomRMSD*>(GetCfgDistance());
+        auto       mol   = GetMolecularStructureRosetta();
+        const int  dim   = GetCfgManager()->GetDim();
+        const int  n     = m_offspringToGenerate;
+        const int  nrCoords = rmsd->GetNrCoords();
+
+        m_threadPool.SetNrThreads(m_nrThreads);
+        while (m_workers.size() < m_threadPool.GetNrThreads())
+        {
+            Worker *worker = new Worker();
+
+            worker->m_fk.SetCfgManager(GetCfgManager());
+            m_workers.push_back(worker);
+        }
+
+        // random choices are drawn serially, in the same order as the serial loop
+        m_candidates.resize(n);
+        for (int i = 0; i < n; ++i)
+            SampleCandidate(m_candidates[i]);
+
+        // the parent is stored in the tree, so its coordinates are cached; the target
+        // is looked up last so that its coordinates stay in the scratch buffers
+        const double *parentCoords = rmsd->GetCoords(*GetParentCfg());
+        const double *targetCoords = rmsd->GetCoords(*m_cfgTarget);
+
+        m_distsToTarget.resize(n);
+        m_distsFromParent.resize(n);
+        m_threadPool.Run(n, [&](const int i, const int thread)
+        {
+            Worker          &w = *(m_workers[thread]);
+            const Candidate &c = m_candidates[i];
+
+            w.m_vals.resize(dim);
+            w.m_atoms.resize(m_parentAtoms.size());
+            w.m_coords.resize(nrCoords + 1);
+
+            ApplyCandidate(c, &w.m_vals[0]);
+            w.m_fk.UpdateBackboneCoords(&w.m_vals[0], c.m_position, c.m_position + c.m_fragmentSize,
+                                        &m_parentAtoms[0], &w.m_atoms[0]);
+            rmsd->ComputeCoordsFromBackbone(&w.m_atoms[0], &w.m_coords[0]);
+
+            m_distsToTarget[i] = Superposition::QCPRMSD(nrCoords / 3, &w.m_coords[0], w.m_coords[nrCoords],
+                                                        targetCoords, targetCoords[nrCoords]);
+            m_distsFromParent[i] = m_distanceTol > 0.0 ?
+                Superposition::QCPRMSD(nrCoords / 3, &w.m_coords[0], w.m_coords[nrCoords],
+                                       parentCoords, parentCoords[nrCoords]) : 0.0;
+        });
+
+        // first candidate with the smallest distance among those within the tolerance
+        int    best      = -1;
+        double smallDist = 999999.99;
+
+        for (int i = 0; i < n; ++i)
+            if (m_distsToTarget[i] < smallDist && (m_distanceTol <= 0.0 || m_distsFromParent[i] <= m_distanceTol))
+            {
+                best      = i;
+                smallDist = m_distsToTarget[i];
+            }
+
+        if (best >= 0)
+        {
+            double *vals = cfg.GetValues();
+
+            ApplyCandidate(m_candidates[best], vals);
+            cfg.SetValues(vals);
+        }
+    }
+
     void CfgOffspringGeneratorRosetta::GenerateOffspringCfg(Cfg & cfg)
     {
         auto cfgManager = GetCfgManager();
 
+        // the parent backbone is computed once and reused by every offspring
+        auto rmsd = dynamic_cast<CfgDistanceAtomRMSD*>(GetCfgDistance());
+        auto mol  = GetMolecularStructureRosetta();
+
+        m_useIncrementalFK = m_incrementalFK && rmsd != NULL && mol->UseNativeBackboneFK();
+        if (m_useIncrementalFK)
+        {
+            m_parentAtoms.resize(3 * mol->GetNrBackboneAtoms());
+            mol->GetNativeBackbone()->GetBackboneCoords(*GetParentCfg(), &m_parentAtoms[0]);
+
+            if (m_nrThreads > 1)
+            {
+                GenerateOffspringCfgInParallel(cfg);
+                return;
+            }
+        }
+
         //don't forget at the end to save
         //so that cfg remembers that the values have been changed.
         //In such cases, it sets the energy to undefined as an indication that it may need to be computed again.
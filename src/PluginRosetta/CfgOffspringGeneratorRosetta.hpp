@@ -13,6 +13,8 @@
 #include <unordered_map>
 
 #include "Utils/Selector.hpp"
+#include "Utils/SelectorAlias.hpp"
+#include "Utils/ThreadPool.hpp"
 
 namespace Antipatrea
 {
@@ -206,6 +208,29 @@ namespace Antipatrea
             if (pos < m_fragments.size())
                 return (m_fragments[pos].size());
         }
+
+        /**
+          *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+          *@brief Select a position uniformly at random and then a fragment
+          *       for that position uniformly at random
+          *
+          *@remarks
+          * - It uses a single random draw: the integer part of the scaled draw
+          *   gives the position and its fractional part gives the fragment.
+        */
+        void Sample(unsigned int &pos,
+                    unsigned int &fragmentNumber) const
+        {
+            const unsigned int npos = m_fragments.size();
+            const double       u    = RandomUniformReal(0, npos);
+
+            pos = u >= npos ? npos - 1 : (unsigned int) u;
+
+            const unsigned int nsamples = m_fragments[pos].size();
+            const double       v        = (u - pos) * nsamples;
+
+            fragmentNumber = v >= nsamples ? nsamples - 1 : (unsigned int) v;
+        }
         /**
           *@author Kevin Molloy, Erion Plaku, Amarda Shehu
           *@brief Return the PHI angle for a specific position, fragment,
@@ -281,10 +306,14 @@ namespace Antipatrea
         {
             m_offspringToGenerate=1;
             m_distanceTol = 0.0;
+            m_incrementalFK = Constants::VAL_OffspringRosetta_IncrementalFK;
+            m_useIncrementalFK = false;
+            m_nrThreads = Constants::VAL_OffspringRosetta_NrThreads;
         }
 
         virtual ~CfgOffspringGeneratorRosetta(void)
         {
+            DeleteItems<Worker*>(m_workers);
         }
 
         /**
@@ -335,7 +364,8 @@ namespace Antipatrea
         {
             CfgOffspringGenerator::Info(prefix);
             Logger::m_out << prefix << " MolecularStructureRosetta = " << Name(GetMolecularStructureRosetta())
-                          << " m_offspringToGenerate = " << m_offspringToGenerate << std::endl;
+                          << " m_offspringToGenerate = " << m_offspringToGenerate
+                          << " m_nrThreads = " << m_nrThreads << std::endl;
         }
 
 
@@ -355,8 +385,69 @@ namespace Antipatrea
         virtual void GenerateOffspringCfg(Cfg & cfg);
 
     protected:
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Random choices that define an offspring: the fragment library (by its length),
+         *       the position where the fragment is inserted, and the fragment at that position.
+         */
+        struct Candidate
+        {
+            int m_fragmentSize;
+            int m_position;
+            int m_fragmentIndex;
+        };
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Per-thread buffers used when evaluating the offspring in parallel.
+         */
+        struct Worker
+        {
+            CfgForwardKinematicsBackbone m_fk;
+            std::vector<double>          m_vals;
+            std::vector<double>          m_atoms;
+            std::vector<double>          m_coords;
+        };
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Draw the random choices of an offspring.
+         */
+        virtual void SampleCandidate(Candidate & candidate);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Set <tt>vals</tt> to the values of the parent with the fragment of the candidate inserted.
+         */
+        virtual void ApplyCandidate(const Candidate & candidate, double vals[]);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Evaluate all the offspring in parallel and copy the closest one into <tt>cfg</tt>.
+         *
+         *@remarks
+         * - The random choices of the offspring are drawn in order on the calling thread, and
+         *   the closest offspring is the first one with the smallest distance, so the result
+         *   is the same as in the serial loop and does not depend on the number of threads.
+         * - The threads evaluate the offspring with their own forward kinematics and
+         *   coordinate buffers (see Worker), so it requires the incremental forward kinematics.
+         */
+        virtual void GenerateOffspringCfgInParallel(Cfg & cfg);
+
         double GenerateAnOffspringCfg(Cfg & cfg);
 
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Compute the RMSD coordinates of the offspring from those of the parent and cache them with it.
+         *
+         *@remarks
+         * - The offspring differs from the parent only in residues <tt>start</tt>, ..., <tt>end - 1</tt>,
+         *   so only that segment is placed again (see CfgForwardKinematicsBackbone::UpdateBackboneCoords).
+         * - The distances to the target and to the parent then use the cached coordinates,
+         *   instead of computing the forward kinematics of the offspring from scratch.
+         */
+        virtual void ComputeOffspringCoords(Cfg & cfg, const int start, const int end);
+
         /**
           *@author Kevin Molloy, Erion Plaku, Amarda Shehu
           *@brief Pointer to the target configuration.
@@ -367,10 +458,11 @@ namespace Antipatrea
             *@author Kevin Molloy, Erion Plaku, Amarda Shehu
             *@brief  Structure to hold fragment library pointers.
          *           Allows easy random selection w/respect to
-         *           the libraries weight.
+         *           the libraries weight. The weights do not change
+         *           after setup, so an alias table is used.
          */
 
-         Selector<int> m_selector;
+         SelectorAlias<int> m_selector;
 
          /**
             *@author Kevin Molloy, Erion Plaku, Amarda Shehu
@@ -407,6 +499,47 @@ namespace Antipatrea
          */
          int m_offspringToGenerate;
 
+         /**
+            *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+            *@brief  Flag indicating whether the forward kinematics of the offspring should be
+            *        computed incrementally from the parent.
+            *
+            *@remarks
+            * - It is used only when the distance is CfgDistanceAtomRMSD and the molecular structure
+            *   computes the backbone natively (see MolecularStructureRosetta::UseNativeBackboneFK),
+            *   since the pose does not expose its kinematic frames.
+         */
+         bool m_incrementalFK;
+
+         /**
+            *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+            *@brief  Set by GenerateOffspringCfg when the incremental forward kinematics can be used.
+         */
+         bool m_useIncrementalFK;
+
+         /**
+            *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+            *@brief  Backbone coordinates of the parent and of the current offspring.
+         */
+         std::vector<double> m_parentAtoms;
+         std::vector<double> m_offspringAtoms;
+
+         /**
+            *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+            *@brief  Number of threads used to evaluate the offspring.
+            *
+            *@remarks
+            * - The offspring are evaluated in parallel only when the incremental forward
+            *   kinematics is used, since the Rosetta pose cannot be shared among threads.
+         */
+         int m_nrThreads;
+
+         ThreadPool             m_threadPool;
+         std::vector<Worker*>   m_workers;
+         std::vector<Candidate> m_candidates;
+         std::vector<double>    m_distsToTarget;
+         std::vector<double>    m_distsFromParent;
+
     };
 
     /**
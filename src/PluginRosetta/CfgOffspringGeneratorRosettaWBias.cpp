@@ -22,8 +22,7 @@ namespace Antipatrea
         const int dim   = cfgManager->GetDim(); //number of configuration dimensions;
         double *vals    = cfg.GetValues();      //values of the configuration
 
-        auto fragmentNode = m_selector.Select();
-        int fragmentSize = fragmentNode->GetKey();
+        int fragmentSize = m_selector.GetKey(m_selector.Select());
 
         if (m_verboseFlag) {
         	std::cout<< "Fragment size selected is:" << fragmentSize << std::endl;
@@ -32,8 +31,10 @@ namespace Antipatrea
         auto &db = m_fragmentMap[fragmentSize];
 
         // auto sampleAAPosition = RandomUniformInteger(0,db.NumberOfPositions() - 1 - (fragmentSize+1));
-        auto sampleAAPosition = RandomUniformInteger(0,db.NumberOfPositions() - 1);
-        auto fragmentIndex = RandomUniformInteger(0,db.NumberOfSamples(sampleAAPosition)-1);
+        unsigned int sampleAAPosition;
+        unsigned int fragmentIndex;
+
+        db.Sample(sampleAAPosition, fragmentIndex);
 
         if (m_verboseFlag)
         {
@@ -29,10 +29,13 @@ namespace Antipatrea
         {
         	m_firstProjection = true;
         	m_verboseFlag = false;
+        	m_initCfg = NULL;
+        	m_goalCfg = NULL;
         }
         
         virtual ~CfgProjectorDeltaR(void)
         {
+        	DeleteCfgs();
         }
         
         virtual bool CheckSetup(void) const
@@ -54,11 +57,19 @@ namespace Antipatrea
 
         virtual void PostSetup()
         {
+        	DeleteCfgs();
+
         	distanceRMSD.SetMolecularStructureRosetta(GetMolecularStructureRosetta());
 			distanceRMSD.SetCfgManager(GetCfgManager());
 
-			m_initCfg = GetPlannerProblem()->GetInitialCfg();
-			m_goalCfg = GetPlannerProblem()->GetGoalCfg();
+			// keep copies of the initial and goal cfgs with their coordinates
+			// cached, since every projection measures the distance to both
+			// (only two cfgs, so they are cached even with packed storage)
+			distanceRMSD.SetCacheCoords(CfgDistanceAtomRMSD::CACHE_ALWAYS);
+			m_initCfg = GetCfgManager()->CopyCfg(*(GetPlannerProblem()->GetInitialCfg()));
+			m_goalCfg = GetCfgManager()->CopyCfg(*(GetPlannerProblem()->GetGoalCfg()));
+			distanceRMSD.OnCfgStored(*m_initCfg);
+			distanceRMSD.OnCfgStored(*m_goalCfg);
 
 			m_rmsdBetween = distanceRMSD.Distance(*m_initCfg,*m_goalCfg);
 			m_cellRange = m_rmsdBetween * 2;
@@ -95,8 +106,23 @@ namespace Antipatrea
          *   (using CfgProjector::NewValues())
          */
         CfgDistanceAtomRMSD distanceRMSD;
-    	const Cfg *m_initCfg;
-    	const Cfg *m_goalCfg;
+    	Cfg *m_initCfg;
+    	Cfg *m_goalCfg;
+
+    	/**
+    	 *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+    	 *@brief Give the copies of the initial and goal cfgs back to CfgManager, which allocated them.
+    	 */
+    	void DeleteCfgs(void)
+    	{
+    		if(m_initCfg)
+    			GetCfgManager()->DeleteCfg(m_initCfg);
+    		if(m_goalCfg)
+    			GetCfgManager()->DeleteCfg(m_goalCfg);
+    		m_initCfg = NULL;
+    		m_goalCfg = NULL;
+    	}
+
     	unsigned int m_cellCount;
     	double m_cellRange;
     	double m_cellSize;
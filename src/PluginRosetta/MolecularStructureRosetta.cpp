@@ -15,7 +15,8 @@
 
 namespace Antipatrea
 {
-    MolecularStructureRosetta::MolecularStructureRosetta(void) : CfgForwardKinematics()
+    MolecularStructureRosetta::MolecularStructureRosetta(void) : CfgForwardKinematics(),
+                                                                 m_useNativeBackboneFK(false)
     {
         //add additional initialization code
     }
@@ -37,6 +38,7 @@ namespace Antipatrea
         //print any additional info
         //see src/Components/CfgDistances/CfgDistanceLp.hpp for an example
         CfgForwardKinematics::Info(prefix);
+        Logger::m_out << prefix << " NativeBackboneFK = " << UseNativeBackboneFK() << std::endl;
     }
     
     void MolecularStructureRosetta::SetupFromParams(Params & params)
@@ -46,8 +48,8 @@ namespace Antipatrea
         auto data = params.GetData(Constants::KW_MolecularStructureRosetta);
         if(data && data->m_params)
         {
-            //setup any other parameters that you may have
-            //see src/Components/CfgDistances/CfgDistanceLp.hpp for an example
+            SetUseNativeBackboneFK(data->m_params->GetValueAsBool(Constants::KW_MolecularStructureRosetta_NativeBackboneFK,
+                                                                  UseNativeBackboneFK()));
         }
     }
     
@@ -93,7 +95,7 @@ namespace Antipatrea
         m_scoreFn = core::scoring::ScoreFunctionFactory::create_score_function(energyWeightFile);
     }
 
-    void MolecularStructureRosetta::LoadPose(const Cfg &cfg)
+    void MolecularStructureRosetta::LoadDihedrals(const Cfg &cfg)
     {
         const double *vals = cfg.GetValues();
 
@@ -103,6 +105,11 @@ namespace Antipatrea
             m_pose.set_psi  (i+1,Algebra2D::RadiansToDegrees(vals[i*3 + 1]));
             m_pose.set_omega(i+1,Algebra2D::RadiansToDegrees(vals[i*3 + 2]));
         }
+    }
+
+    void MolecularStructureRosetta::LoadPose(const Cfg &cfg)
+    {
+        LoadDihedrals(cfg);
 
         // whenever we change any angles, we need to update the SS
         core::pose::set_ss_from_phipsi(m_pose);
@@ -138,9 +145,21 @@ namespace Antipatrea
 
     std::vector<point>  MolecularStructureRosetta::GetAtomPositions(const Cfg &cfgToSet)
     {
+        std::vector<point> crds;
+
+        if(UseNativeBackboneFK())
+        {
+            std::vector<double> coords(3 * GetNrBackboneAtoms());
+
+            GetBackboneCoords(cfgToSet, &coords[0]);
+            crds.reserve(GetNrBackboneAtoms());
+            for(int i = 0; i < (int) coords.size(); i += 3)
+                crds.push_back(point(coords[i], coords[i + 1], coords[i + 2]));
+            return crds;
+        }
+
         LoadPose(cfgToSet);
 
-        std::vector<point> crds;
         std::vector<std::string> atomTypes = {"N","CA","C"};
         crds.reserve(m_pose.total_residue() * atomTypes.size());
         for (uint i=1; i<=m_pose.total_residue(); i++)
@@ -156,6 +175,31 @@ namespace Antipatrea
         return crds;
     }
 
+    void MolecularStructureRosetta::GetBackboneCoords(const Cfg &cfg, double coords[])
+    {
+        if(UseNativeBackboneFK())
+        {
+            GetNativeBackbone()->GetBackboneCoords(cfg, coords);
+            return;
+        }
+
+        LoadDihedrals(cfg);
+
+        const char *atomTypes[] = {"N","CA","C"};
+        for (uint i=1; i<=m_pose.total_residue(); i++)
+        {
+            const core::conformation::Residue & r = m_pose.residue(i);
+            for (auto j=0;j < 3;++j)
+            {
+                const core::conformation::Atom &a = r.atom(r.atom_index(atomTypes[j]));
+                coords[0] = a.xyz().x();
+                coords[1] = a.xyz().y();
+                coords[2] = a.xyz().z();
+                coords += 3;
+            }
+        }
+    }
+
     void MolecularStructureRosetta::SetExtented(Cfg &cfg)
     {
         for (uint i=1;i <= m_pose.total_residue();++i)
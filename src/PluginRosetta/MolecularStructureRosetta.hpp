@@ -2,6 +2,7 @@
 #define Antipatrea_MolecularStructureRosetta_HPP_
 
 #include "Components/CfgForwardKinematics/CfgForwardKinematics.hpp"
+#include "Components/CfgForwardKinematics/CfgForwardKinematicsBackbone.hpp"
 #include "Utils/Misc.hpp"
 #include <vector>
 
@@ -112,6 +113,64 @@ namespace Antipatrea
          */
         virtual std::vector<point>  GetAtomPositions(const Cfg &cfg);
 
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Return the number of backbone atoms (N-CA-C) whose coordinates are
+         *       computed by GetBackboneCoords.
+         */
+        virtual int GetNrBackboneAtoms(void) const
+        {
+            return 3 * GetNrResidues();
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Write the 3-d coordinates of the backbone atoms (N-CA-C) of the
+         *       configuration into <tt>coords</tt> as x0 y0 z0 x1 y1 z1 ...
+         *
+         *@remarks
+         * - <tt>coords</tt> should have room for 3 * GetNrBackboneAtoms() values.
+         * - Unlike GetAtomPositions, it does not update the secondary structure of the pose,
+         *   since that is not needed to obtain the coordinates.
+         * - If UseNativeBackboneFK() is true, the coordinates are computed by CfgForwardKinematicsBackbone
+         *   instead of the pose.
+         */
+        virtual void GetBackboneCoords(const Cfg &cfg, double coords[]);
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Return true iff the backbone coordinates are computed directly from the
+         *       dihedral angles (see CfgForwardKinematicsBackbone) rather than by the Rosetta pose.
+         *
+         *@remarks
+         * - The native computation uses ideal bond lengths and angles, so the coordinates differ from
+         *   the pose by a rigid-body transformation plus small deviations in the bond geometry.
+         *   This is fine for superposition-based (RMSD) and distance-based (USR) measures.
+         */
+        virtual bool UseNativeBackboneFK(void) const
+        {
+            return m_useNativeBackboneFK;
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Set whether the backbone coordinates are computed directly from the dihedral angles.
+         */
+        virtual void SetUseNativeBackboneFK(const bool use)
+        {
+            m_useNativeBackboneFK = use;
+        }
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Get the backbone forward kinematics used when UseNativeBackboneFK() is true.
+         */
+        virtual CfgForwardKinematicsBackbone* GetNativeBackbone(void)
+        {
+            m_nativeBackbone.SetCfgManager(GetCfgManager());
+            return &m_nativeBackbone;
+        }
+
     protected:
         /**
          *@author Erion Plaku, Amarda Shehu
@@ -124,6 +183,13 @@ namespace Antipatrea
          */
         virtual void DoFK(void);
 
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Export the dihedral angles of the configuration into the pose object
+         *       without updating its secondary structure.
+         */
+        virtual void LoadDihedrals(const Cfg &cfg);
+
 
         /**
          *@author Erion Plaku, Amarda Shehu, Kevin Molloy
@@ -141,6 +207,18 @@ namespace Antipatrea
           *
           */
         core::scoring::ScoreFunctionOP m_scoreFn;
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Flag indicating whether the backbone coordinates are computed by <tt>m_nativeBackbone</tt>.
+         */
+        bool m_useNativeBackboneFK;
+
+        /**
+         *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+         *@brief Backbone forward kinematics that does not go through the pose.
+         */
+        CfgForwardKinematicsBackbone m_nativeBackbone;
     };
 
     /**
@@ -170,7 +170,7 @@ extern "C" int RunPlanner(int argc, char **argv)
 		Logger::m_out << "\n" << std::endl
 						  << "[nrVertices    = " << planner->GetPlannerGraph()->GetNrVertices() << "] " << std::endl
 						  << "[nrEdges       = " << planner->GetPlannerGraph()->GetNrEdges() << "] " << std::endl
-						  << "[nrComponents  = " << planner->GetPlannerGraph()->GetComponents()->GetNrComponents() << "]" << std::endl
+						  << "[nrComponents  = " << planner->GetPlannerGraph()->GetNrComponents() << "]" << std::endl
 						  << "[runtime       = " << Timer::Elapsed(clk) << "]" << std::endl;
 		auto goalAcceptor = planner->GetPlannerProblem()->GetGoalAcceptor();
 
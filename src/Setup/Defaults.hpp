@@ -17,7 +17,16 @@ namespace Antipatrea
         const char KW_UseCfgManager[]  = "UseCfgManager";
         const char KW_CfgManager[]     = "CfgManager";
         const char KW_Dim[]            = "Dim";
-        
+        const char KW_NrCfgsPerChunk[] = "NrCfgsPerChunk";
+        const char KW_CfgStorage[]     = "CfgStorage";
+
+        const int  VAL_CfgManager_NrCfgsPerChunk   = 1024;
+        const int  VAL_CfgManager_ValuesAlignment  = 4;
+        const int  VAL_CfgManager_NrUnpackBuffers  = 32;
+        const char VAL_CfgManager_StorageDouble[]  = "Double";
+        const char VAL_CfgManager_StorageFloat[]   = "Float";
+        const char VAL_CfgManager_StorageAngle16[] = "Angle16";
+
         //CfgAcceptors
         const char KW_UseCfgAcceptor[]             = "UseCfgAcceptor";
         const char KW_CfgAcceptor[]                = "CfgAcceptor";
@@ -63,6 +72,11 @@ namespace Antipatrea
         const char KW_CfgDistanceLp[]  = "CfgDistanceLp";
         const char KW_Exponent[]       = "Exponent";
         const char KW_CfgDistanceAtomRMSD[] = "CfgDistanceAtomRMSD";
+        const char KW_CacheCoords[]         = "CacheCoords";
+
+        const char VAL_CfgDistanceAtomRMSD_CacheAuto[]   = "Auto";
+        const char VAL_CfgDistanceAtomRMSD_CacheAlways[] = "Always";
+        const char VAL_CfgDistanceAtomRMSD_CacheNever[]  = "Never";
         
         const int VAL_CfgDistanceLp_Exponent = 2;
                 
@@ -106,6 +120,15 @@ namespace Antipatrea
         //CfgForwardKinematics
         const char KW_UseCfgForwardKinematics[] = "UseCfgForwardKinematics";
         const char KW_CfgForwardKinematics[]    = "CfgForwardKinematics";
+        const char KW_CfgForwardKinematicsBackbone[] = "CfgForwardKinematicsBackbone";
+
+        //ideal backbone geometry (Engh and Huber), lengths in angstroms and angles in radians
+        const double VAL_CfgForwardKinematicsBackbone_BondLengthNCA = 1.458;
+        const double VAL_CfgForwardKinematicsBackbone_BondLengthCAC = 1.525;
+        const double VAL_CfgForwardKinematicsBackbone_BondLengthCN  = 1.329;
+        const double VAL_CfgForwardKinematicsBackbone_BondAngleNCAC = 111.2 * M_PI / 180;
+        const double VAL_CfgForwardKinematicsBackbone_BondAngleCACN = 116.2 * M_PI / 180;
+        const double VAL_CfgForwardKinematicsBackbone_BondAngleCNCA = 121.7 * M_PI / 180;
                  
         //CfgProjector
         const char KW_UseCfgProjector[] = "UseCfgProjector";
@@ -141,8 +164,16 @@ namespace Antipatrea
         //SamplingBasedPlanner
         const char KW_SamplingBasedPlanner[] = "SamplingBasedPlanner";
         const char KW_OneStepDistance[]      = "OneStepDistance";
+        const char KW_ProximityNrThreads[]   = "ProximityNrThreads";
+        const char KW_ProximityEpsilon[]     = "ProximityEpsilon";
+        const char KW_ProximityMaxNrDistanceEvaluations[] = "ProximityMaxNrDistanceEvaluations";
+        const char KW_ProximityTorus[]       = "ProximityTorus";
         
-        const double VAL_SamplingBasedPlanner_OneStepDistance = 0.1;
+        const double VAL_SamplingBasedPlanner_OneStepDistance    = 0.1;
+        const int    VAL_SamplingBasedPlanner_ProximityNrThreads = 1;
+        const double VAL_SamplingBasedPlanner_ProximityEpsilon   = 0.0;
+        const int    VAL_SamplingBasedPlanner_ProximityMaxNrDistanceEvaluations = std::numeric_limits<int>::max();
+        const bool   VAL_SamplingBasedPlanner_ProximityTorus     = true;
         
         //PRM
         const char KW_PRM[]                         = "PRM";
@@ -184,6 +215,8 @@ namespace Antipatrea
         const char   VAL_FELTR_ENERGY_QUAD[]        = "QUAD";
         const char   VAL_FELTR_ENERGY_LINEAR[]      = "LINEAR";
         const char   VAL_FELTR_ENERGY_NORM[]        = "NORM";
+        const char   KW_FELTR_CELL_INDEX[]          = "CellIndex";
+        const bool   VAL_FELTR_CellIndex            = true;
         //SPRINT
         const char   KW_SPRINT[]                    = "Sprint";
         const char   KW_SPRINT_REGION_EXP[]         = "RegionExp";
@@ -218,6 +251,7 @@ namespace Antipatrea
         const char KW_Runtime_PlannerStart[]         = "Runtime_PlannerStart";
         const char KW_Runtime_PRM_GenerateVertices[] = "Runtime_PRM_GenerateVertices";
         const char KW_Runtime_PRM_GenerateEdges[]    = "Runtime_PRM_GenerateEdges";
+        const char KW_NrProximityDistanceEvaluations[] = "NrProximityDistanceEvaluations";
 
 
 
@@ -253,8 +287,12 @@ namespace Antipatrea
         const char   KW_OffspringRosetta_FragmentProbabilities[] = "FragmentProbabilities";
         const char   KW_OffspringRosetta_NumberToGenerate[]      = "NumberToGenerate";
         const char   KW_OffspringRosetta_DistanceTol[]      = "DistanceTol";
+        const char   KW_OffspringRosetta_IncrementalFK[]    = "IncrementalFK";
+        const char   KW_OffspringRosetta_NrThreads[]        = "NrThreads";
         const int    VAL_OffspringRosetta_NumberToGenerate  = 10;
         const double VAL_OffspringRosetta_DistanceTol       = 0.0;
+        const bool   VAL_OffspringRosetta_IncrementalFK     = true;
+        const int    VAL_OffspringRosetta_NrThreads         = 1;
 
         const char KW_MolecularStructureRosetta_OffspringToGenerate[] = "OffspringToGenerate";
         const char KW_MolecularStructureRosetta_WeightFile[]   = "WeightFile";
@@ -264,6 +302,7 @@ namespace Antipatrea
         const char KW_MolecularStructureRosetta_CfgStartExtended[] = "CfgStartExtended";
 
         const char KW_MolecularStructureRosetta_CfgGoal[] = "CfgGoal";
+        const char KW_MolecularStructureRosetta_NativeBackboneFK[] = "NativeBackboneFK";
         const char KW_CfgSamplerRosetta[]            = "CfgSamplerRosetta";
         const char KW_CfgImproverRosetta[]           = "CfgImproverRosetta";
         const char KW_CfgOffspringGeneratorRosetta[] = "CfgOffspringGeneratorRosetta";
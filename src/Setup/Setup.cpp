@@ -15,6 +15,8 @@
 #include "Components/CfgDistances/SignedDistanceBetweenTwoNumbers.hpp"
  
 #include "Components/CfgSamplers/CfgUniformSamplerInJointSpace.hpp"
+
+#include "Components/CfgForwardKinematics/CfgForwardKinematicsBackbone.hpp"
   
 #include "Components/CfgImprovers/CfgImproverDoNothing.hpp"
 
@@ -144,7 +146,14 @@ namespace Antipatrea
     }
     
     void Setup::NewCfgForwardKinematics(Params & params)
-    {        
+    {
+        auto name = params.GetValue(Constants::KW_UseCfgForwardKinematics);
+
+        if (StrSameContent(name, Constants::KW_CfgForwardKinematicsBackbone))
+        {
+            SetCfgForwardKinematics(new CfgForwardKinematicsBackbone());
+            OnNewInstance(GetCfgForwardKinematics());
+        }
     }
     
     void Setup::NewCfgImprover(Params & params)
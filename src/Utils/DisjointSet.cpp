@@ -9,6 +9,7 @@ namespace Antipatrea
         
         elem->m_rank   = 0;
         elem->m_parent = NULL;
+        elem->m_marks  = 0;
         ++m_nrComps;
 
         return elem;
@@ -37,6 +38,8 @@ namespace Antipatrea
         
         if(xRoot != yRoot)
         {
+            const int marks = xRoot->m_marks | yRoot->m_marks;
+
             if(xRoot->m_rank > yRoot->m_rank)
                 yRoot->m_parent = xRoot;
             else if(xRoot->m_rank < yRoot->m_rank)
@@ -46,6 +49,7 @@ namespace Antipatrea
                 yRoot->m_parent = xRoot;
                 ++(xRoot->m_rank);
             }
+            xRoot->m_marks = yRoot->m_marks = marks;
             --m_nrComps;
         }
     }
@@ -16,10 +16,18 @@ namespace Antipatrea
         {
         }
 
+        /**
+         *@brief Element of the disjoint set.
+         *
+         *@remarks
+         * - <tt>m_marks</tt> is a bit mask that is meaningful only for the root of a set.
+         *   Join combines the marks of the two sets (see Mark and GetMarks).
+         */
         struct Elem
         {
             int    m_rank;
             Elem  *m_parent;
+            int    m_marks;
         };
 
 
@@ -39,6 +47,16 @@ namespace Antipatrea
             return Find(x) == Find(y);
         }
 
+        void Mark(Elem * x, const int marks)
+        {
+            Find(x)->m_marks |= marks;
+        }
+
+        int GetMarks(Elem * x)
+        {
+            return Find(x)->m_marks;
+        }
+
     protected:
         int  m_nrComps;
     };
@@ -0,0 +1,203 @@
+#include "Utils/GraphSearchDense.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Antipatrea
+{
+    GraphSearchDense::Data& GraphSearchDense::Reach(const int u)
+    {
+        if(u >= (int) m_data.size())
+        {
+            Data none;
+
+            none.m_generation = 0;
+            m_data.resize(std::max(u + 1, 2 * (int) m_data.size()), none);
+        }
+
+        Data & data = m_data[u];
+
+        data.m_generation = m_generation;
+        return data;
+    }
+
+    void GraphSearchDense::HeapUp(int pos)
+    {
+        const HeapItem item = m_heap[pos];
+
+        while(pos > 0)
+        {
+            const int parent = (pos - 1) / 2;
+
+            if(!(item.m_fCost < m_heap[parent].m_fCost))
+                break;
+            m_heap[pos] = m_heap[parent];
+            m_data[m_heap[pos].m_key].m_heapPos = pos;
+            pos = parent;
+        }
+        m_heap[pos] = item;
+        m_data[item.m_key].m_heapPos = pos;
+    }
+
+    void GraphSearchDense::HeapDown(int pos)
+    {
+        const int      n    = m_heap.size();
+        const HeapItem item = m_heap[pos];
+
+        while(true)
+        {
+            int child = 2 * pos + 1;
+
+            if(child >= n)
+                break;
+            if(child + 1 < n && m_heap[child + 1].m_fCost < m_heap[child].m_fCost)
+                ++child;
+            if(!(m_heap[child].m_fCost < item.m_fCost))
+                break;
+            m_heap[pos] = m_heap[child];
+            m_data[m_heap[pos].m_key].m_heapPos = pos;
+            pos = child;
+        }
+        m_heap[pos] = item;
+        m_data[item.m_key].m_heapPos = pos;
+    }
+
+    bool GraphSearchDense::AStar(const int start, const bool breakEarly, int & goal)
+    {
+        HeapItem item;
+
+        // a new generation invalidates the data of the previous search
+        if(++m_generation == 0)
+        {
+            for(auto & data : m_data)
+                data.m_generation = 0;
+            m_generation = 1;
+        }
+        m_heap.clear();
+
+        Data & datas = Reach(start);
+
+        datas.m_parent = start;
+        datas.m_gCost  = 0;
+        datas.m_hCost  = m_info->HeuristicCostToGoal(start);
+        item.m_key     = start;
+        item.m_fCost   = datas.m_gCost + datas.m_hCost;
+        m_heap.push_back(item);
+        datas.m_heapPos = 0;
+
+        while(!m_heap.empty())
+        {
+            //remove top
+            const int u = m_heap[0].m_key;
+
+            m_heap[0] = m_heap.back();
+            m_heap.pop_back();
+            if(!m_heap.empty())
+                HeapDown(0);
+            m_data[u].m_heapPos = CLOSED;
+
+            if(m_info->IsGoal(u))
+            {
+                goal = u;
+                return true;
+            }
+
+            //get edges and costs
+            const double gu = m_data[u].m_gCost;
+
+            m_edges.clear();
+            m_costs.clear();
+            m_info->GetOutEdges(u, m_edges, m_costs);
+
+            //process edges
+            for(int i = m_edges.size() - 1; i >= 0; --i)
+            {
+                const int    v  = m_edges[i];
+                const double gv = gu + m_costs[i];
+
+                if(!IsReached(v))
+                {
+                    const double hv = m_info->HeuristicCostToGoal(v);
+
+                    if(hv != INFINITY)
+                    {
+                        Data & datav = Reach(v);
+
+                        datav.m_parent = u;
+                        datav.m_gCost  = gv;
+                        datav.m_hCost  = hv;
+                        item.m_key     = v;
+                        item.m_fCost   = gv + hv;
+                        m_heap.push_back(item);
+                        HeapUp(m_heap.size() - 1);
+                        if(breakEarly && m_info->IsGoal(v))
+                        {
+                            goal = v;
+                            return true;
+                        }
+                    }
+                }
+                else
+                {
+                    Data & datav = m_data[v];
+
+                    if(datav.m_heapPos != CLOSED && gv < datav.m_gCost)
+                    {
+                        datav.m_parent = u;
+                        datav.m_gCost  = gv;
+                        m_heap[datav.m_heapPos].m_fCost = gv + datav.m_hCost;
+                        HeapUp(datav.m_heapPos);
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    void GraphSearchDense::GetReversePathFromStart(const int u, std::vector<int> & rpath) const
+    {
+        rpath.clear();
+
+        if(!IsReached(u))
+            return;
+
+        int p = u, v;
+
+        do
+        {
+            v = p;
+            rpath.push_back(v);
+            p = m_data[v].m_parent;
+        }
+        while(v != p);
+    }
+
+    void GraphSearchDense::GetPathFromStart(const int u, std::vector<int> & path) const
+    {
+        GetReversePathFromStart(u, path);
+        ReverseItems<int>(path);
+    }
+
+    int GraphSearchDense::GetPathLengthFromStart(const int u) const
+    {
+        if(!IsReached(u))
+            return -1;
+
+        int p = u, v;
+        int count = 0;
+
+        do
+        {
+            v = p;
+            ++count;
+            p = m_data[v].m_parent;
+        }
+        while(v != p);
+
+        return count;
+    }
+
+    double GraphSearchDense::GetPathCostFromStart(const int u) const
+    {
+        return IsReached(u) ? m_data[u].m_gCost : INFINITY;
+    }
+}
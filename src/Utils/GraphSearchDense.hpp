@@ -0,0 +1,91 @@
+#ifndef Antipatrea__GraphSearchDense_HPP_
+#define Antipatrea__GraphSearchDense_HPP_
+
+#include "Utils/GraphSearch.hpp"
+#include <vector>
+
+namespace Antipatrea
+{
+    /**
+     *@author Erion Plaku, Amarda Shehu
+     *@brief A* for graphs whose vertices are the integers <tt>0, 1, 2, ...</tt>
+     *
+     *@remarks
+     * - It has the same interface and results as GraphSearch<int>::AStar, but the data of each
+     *   vertex (parent, costs, position in the heap) is kept in a vector indexed by the vertex id,
+     *   so there is no hashing.
+     * - Each vertex has the generation of the search that last reached it. Starting a new search only
+     *   increments the current generation, so the vectors are not cleared between searches.
+     * - The open list is a binary heap that stores the f-cost next to the vertex id,
+     *   so the comparisons do not look up the vertex data.
+     * - The vectors grow as needed to accommodate the vertex ids that are reached.
+     */
+    class GraphSearchDense
+    {
+    public:
+        GraphSearchDense(void) : m_info(NULL),
+                                 m_generation(0)
+        {
+        }
+
+        virtual ~GraphSearchDense(void)
+        {
+        }
+
+        void SetInfo(GraphSearchInfo<int> *info)
+        {
+            m_info = info;
+        }
+
+        bool AStar(const int start, const bool breakEarly, int & goal);
+
+        void GetReversePathFromStart(const int u, std::vector<int> & rpath) const;
+
+        void GetPathFromStart(const int u, std::vector<int> & path) const;
+
+        int GetPathLengthFromStart(const int u) const;
+
+        double GetPathCostFromStart(const int u) const;
+
+    protected:
+        enum
+            {
+                CLOSED = -1
+            };
+
+        struct Data
+        {
+            unsigned int m_generation;
+            int          m_parent;
+            int          m_heapPos;
+            double       m_gCost;
+            double       m_hCost;
+        };
+
+        struct HeapItem
+        {
+            double m_fCost;
+            int    m_key;
+        };
+
+        bool IsReached(const int u) const
+        {
+            return u >= 0 && u < (int) m_data.size() && m_data[u].m_generation == m_generation;
+        }
+
+        Data& Reach(const int u);
+
+        void HeapUp(int pos);
+
+        void HeapDown(int pos);
+
+        GraphSearchInfo<int> *m_info;
+        unsigned int          m_generation;
+        std::vector<Data>     m_data;
+        std::vector<HeapItem> m_heap;
+        std::vector<int>      m_edges;
+        std::vector<double>   m_costs;
+    };
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include "Utils/Constants.hpp"
 #include "Utils/Logger.hpp"
 #include <vector>
+#include <unordered_map>
 
 namespace Antipatrea
 {
@@ -23,6 +23,12 @@ namespace Antipatrea
 
         typedef double (*DistFn) (const Key, const Key, DistFnData);
 
+        /**
+         *@brief Function invoked by RangeNeighbors for each key within the range,
+         *       together with its distance from the query key.
+         */
+        typedef void (*VisitFn) (const Key, const double, void *);
+
         DistFn     m_distFn;
         DistFnData m_distFnData;
         
@@ -57,6 +63,22 @@ namespace Antipatrea
             ClearDataStructure();
         }
 
+        /**
+         *@brief Signal that many keys are about to be added, e.g., when reading a saved roadmap.
+         *
+         *@remarks
+         * - Between BeginBulkInsert and EndBulkInsert, a data structure may defer indexing the added keys
+         *   and index all of them at once in EndBulkInsert. Queries issued in between may not see them.
+         * - The default implementation does nothing.
+         */
+        virtual void BeginBulkInsert(void)
+        {
+        }
+
+        virtual void EndBulkInsert(void)
+        {
+        }
+
         virtual Key Neighbor(ProximityQuery<Key> & query, double * const d = NULL)
         {
             ProximityResults<Key> pr;
@@ -79,7 +101,60 @@ namespace Antipatrea
         virtual void Neighbors(ProximityQuery<Key>   & query, 
                                ProximityResults<Key> & results) = 0;
 
+        /**
+         *@brief Compute the neighbors for each of the <tt>nrQueries</tt> queries;
+         *       the results of <tt>queries[i]</tt> are stored in <tt>results[i]</tt>.
+         *
+         *@remarks
+         * - The default implementation answers the queries one after the other.
+         */
+        virtual void Neighbors(const int               nrQueries,
+                               ProximityQuery<Key>     queries[],
+                               ProximityResults<Key>   results[])
+        {
+            for(int i = 0; i < nrQueries; ++i)
+                Neighbors(queries[i], results[i]);
+        }
+
+        /**
+         *@brief Invoke <tt>visitFn(key, d, visitData)</tt> for each key whose distance <tt>d</tt>
+         *       from <tt>qkey</tt> is less than <tt>range</tt>.
+         *
+         *@remarks
+         * - Unlike Neighbors, there is no bound on the number of keys and the keys are not
+         *   sorted or stored, so the cost depends only on the keys within the range.
+         * - The keys are visited in no particular order.
+         * - The default implementation checks every key.
+         */
+        virtual void RangeNeighbors(const Key qkey, const double range, VisitFn visitFn, void *visitData)
+        {
+            const int size = m_keys.size();
+
+            for(int i = 0; i < size; ++i)
+            {
+                const double d = m_distFn(qkey, m_keys[i], m_distFnData);
+                if(d < range)
+                    visitFn(m_keys[i], d, visitData);
+            }
+        }
+
+        /**
+         *@brief Return the number of keys whose distance from <tt>qkey</tt> is less than <tt>range</tt>.
+         */
+        virtual int RangeCount(const Key qkey, const double range)
+        {
+            int count = 0;
+
+            RangeNeighbors(qkey, range, CountFn, &count);
+            return count;
+        }
+
     protected:
+        static void CountFn(const Key, const double, void *count)
+        {
+            ++(*((int *) count));
+        }
+
         bool             m_construct;
         std::vector<Key> m_keys;        
     };      
@@ -4,414 +4,970 @@
 #include "Utils/Proximity.hpp"
 #include "Utils/PseudoRandom.hpp"
 #include "Utils/Misc.hpp"
+#include "Utils/ReadWriteLock.hpp"
+#include "Utils/ThreadPool.hpp"
 #include <queue>
+#include <algorithm>
+#include <mutex>
 
 namespace Antipatrea
 {
+    /**
+     *@author Erion Plaku, Amarda Shehu
+     *@brief Geometric near-neighbor access tree (GNAT) for nearest-neighbors queries in metric spaces.
+     *
+     *@remarks
+     * - Queries do not modify the tree: the scratch state of a query (scheduler, pruning flags,
+     *   distances to the centers) is kept in a QueryContext. Each thread uses its own context
+     *   (a thread-local one, unless one is passed explicitly).
+     * - Many threads can query the tree concurrently while at most one thread adds keys:
+     *   queries hold a read lock and AddKey/ConstructDataStructure/ClearDataStructure hold a write lock.
+     * - The distance function must itself be safe to call from the querying threads.
+     * - ConstructDataStructure builds the whole tree at once (bulk load). With more than one thread
+     *   (see SetNrThreads), the k-centers distances of a large node are computed in parallel and
+     *   the other nodes of the same level are partitioned as independent tasks. The first center of
+     *   each node is derived from a seed that is drawn once for the root and mixed with the child index,
+     *   so the tree does not depend on the number of threads or on the order in which the tasks run.
+     *   The distance function is then also called concurrently while building the tree.
+     * - Keys added between BeginBulkInsert and EndBulkInsert are not inserted one at a time;
+     *   instead, the tree is bulk-loaded again by EndBulkInsert.
+     * - The tree is stored in a few flat arrays rather than as separately allocated nodes:
+     *   nodes are referred to by their index in <tt>m_nodes</tt>, the children of a node are
+     *   consecutive entries, the pivot ranges of a node are a single block of <tt>m_ranges</tt>,
+     *   and the keys of a leaf are a fixed-capacity span (bucket) of <tt>m_leafKeys</tt>.
+     *   This keeps the data touched by a query close together and avoids the per-node
+     *   allocations and vector headers.
+     * - Neighbors supports approximate queries (see ProximityQuery::SetEpsilon and
+     *   ProximityQuery::SetMaxNrDistanceEvaluations): subtrees are pruned against the current
+     *   radius shrunk by a factor 1 + epsilon, and the search stops once the budget of distance
+     *   evaluations is spent. The number of evaluations is reported in the results.
+     * - A batch of queries (see Neighbors(nrQueries, queries, results)) is answered by the thread pool,
+     *   one query per task. The order in which a query visits the children of a node is drawn from
+     *   a generator local to the query and seeded per query, so the results of a batch do not depend
+     *   on the number of threads.
+     */
     template <typename Key, typename DistFnData>
     class ProximityGNAT : public Proximity<Key, DistFnData>
     {
     public:
-        ProximityGNAT(const int minDegree      =2, 
-                      const int mainDegree     =3, 
-                      const int maxDegree      =3, 
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Scratch state of a query.
+         */
+        class QueryContext
+        {
+        public:
+            struct Scheduled
+            {
+                int    m_node;
+                double m_distToCenter;
+                double m_priority;
+            };
+
+            struct LessFn
+            {
+                bool operator()(const Scheduled & a, const Scheduled & b) const
+                {
+                    return a.m_priority > b.m_priority;
+                }
+            };
+
+            std::priority_queue<Scheduled, std::vector<Scheduled>, LessFn> m_scheduler;
+            std::vector<int>                                                m_perm;
+            std::vector<double>                                             m_distsToCenters;
+            std::vector<int>                                                m_stack;
+            int                                                             m_nrDistEvals;
+            int                                                             m_maxNrDistEvals;
+            double                                                          m_shrink;
+            unsigned long long                                              m_rng;
+        };
+
+        ProximityGNAT(const int minDegree      =2,
+                      const int mainDegree     =3,
+                      const int maxDegree      =3,
                       const int maxNrPtsInLeaf =4) :
             Proximity<Key, DistFnData>()
         {
-            m_root           = NULL;
             m_mainDegree     = mainDegree;
             m_minDegree      = minDegree;
             m_maxDegree      = maxDegree;
             m_maxNrPtsInLeaf = maxNrPtsInLeaf;
-            m_centers        = (int *) calloc(m_maxDegree, sizeof(int));
-            m_perm           = (int *) calloc(m_maxDegree, sizeof(int));
-            m_dists          = NULL;
-            m_cap_dists      = 0;
+            m_bulkInsert     = false;
+
+            // a leaf is expanded as soon as it has more than max(maxNrPtsInLeaf, degree) keys
+            m_bucketSize     = 1 + std::max(std::max(m_maxNrPtsInLeaf, m_mainDegree),
+                                            std::max(m_minDegree, m_maxDegree));
         }
 
         virtual ~ProximityGNAT(void)
         {
-            ClearScheduler();
-            if(m_root)
-                delete m_root;
-            if(m_centers)
-                free(m_centers);
-            if(m_perm)
-                free(m_perm);
-            if(m_dists)
-            {
-                for(int i = 0; i < m_cap_dists; i++)
-                    if(m_dists[i])
-                        free(m_dists[i]);
-                free(m_dists);
-            }
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Get the number of threads (including the calling thread) used to build the tree.
+         */
+        virtual int GetNrThreads(void) const
+        {
+            return m_threadPool.GetNrThreads();
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Set the number of threads (including the calling thread) used to build the tree.
+         */
+        virtual void SetNrThreads(const int nrThreads)
+        {
+            ReadWriteLock::WriteGuard guard(m_rwLock);
+
+            m_threadPool.SetNrThreads(nrThreads);
         }
 
         virtual void AddKey(const Key key)
         {
+            ReadWriteLock::WriteGuard guard(m_rwLock);
+
             Proximity<Key,DistFnData>::AddKey(key);
-            if(this->IsDataStructureConstructed())
+            if(this->IsDataStructureConstructed() && m_bulkInsert == false)
             {
-                m_root->InsertKey(this, key);
+                InsertKey(key);
             }
         }
 
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Keys added from now on are only recorded; the tree is bulk-loaded again by EndBulkInsert.
+         *
+         *@remarks
+         * - Queries issued before EndBulkInsert do not see the keys added since BeginBulkInsert.
+         */
+        virtual void BeginBulkInsert(void)
+        {
+            ReadWriteLock::WriteGuard guard(m_rwLock);
+
+            m_bulkInsert = true;
+        }
+
+        virtual void EndBulkInsert(void)
+        {
+            ReadWriteLock::WriteGuard guard(m_rwLock);
+
+            if(m_bulkInsert == false)
+                return;
+            m_bulkInsert = false;
+            if(this->IsDataStructureConstructed())
+                DoConstructDataStructure();
+        }
+
         virtual void ClearDataStructure(void)
         {
-            Proximity<Key,DistFnData>::ClearDataStructure();            
-            ClearScheduler();
-            if(m_root)
-                delete m_root;
-            m_root = NULL;
+            ReadWriteLock::WriteGuard guard(m_rwLock);
+
+            Proximity<Key,DistFnData>::ClearDataStructure();
+            ClearTree();
         }
 
         virtual void ConstructDataStructure(void)
         {
-            const int size = this->m_keys.size();
-            
-            Proximity<Key,DistFnData>::ConstructDataStructure();
-            
-            m_root           = new Node(NULL, -1);
-            m_root->m_degree = m_mainDegree;
-            for(int i = 0; i < size; i++)
-                m_root->m_keys.push_back(this->m_keys[i]);
-            if(m_root->ShouldExpand(this))
-                m_root->Expand(this);
+            ReadWriteLock::WriteGuard guard(m_rwLock);
+
+            DoConstructDataStructure();
         }
 
-        virtual void Neighbors(ProximityQuery<Key>   & query, 
+        virtual void Neighbors(ProximityQuery<Key>   & query,
                                ProximityResults<Key> & results)
         {
-            if(this->IsDataStructureConstructed() == false)
-                this->ConstructDataStructure();
-         
+            Neighbors(query, results, GetThreadQueryContext());
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Same as Neighbors(query, results), but using <tt>ctx</tt> for the scratch state of the query.
+         */
+        virtual void Neighbors(ProximityQuery<Key>   & query,
+                               ProximityResults<Key> & results,
+                               QueryContext          & ctx)
+        {
+            EnsureConstructed();
+
+            ReadWriteLock::ReadGuard guard(m_rwLock);
+
+            DoNeighbors(query, results, RandomUniformInteger(0, RANDOM_MAX - 1), ctx);
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Compute the neighbors for each of the <tt>nrQueries</tt> queries;
+         *       the results of <tt>queries[i]</tt> are stored in <tt>results[i]</tt>.
+         *
+         *@remarks
+         * - The queries are distributed among the threads of the pool (see SetNrThreads),
+         *   each using the query context of its thread.
+         * - Batches issued concurrently by different threads are answered one after the other.
+         */
+        virtual void Neighbors(const int               nrQueries,
+                               ProximityQuery<Key>     queries[],
+                               ProximityResults<Key>   results[])
+        {
+            EnsureConstructed();
+
+            std::lock_guard<std::mutex> batch(m_batchMutex);
+            ReadWriteLock::ReadGuard    guard(m_rwLock);
+            const unsigned long long    seed = MixSeed(RandomUniformInteger(0, RANDOM_MAX - 1));
+
+            m_threadPool.Run(nrQueries, [this, queries, results, seed](const int task, const int)
+                             {
+                                 DoNeighbors(queries[task], results[task], MixSeed(seed + task), GetThreadQueryContext());
+                             });
+        }
+
+        virtual void RangeNeighbors(const Key qkey,
+                                    const double range,
+                                    typename Proximity<Key, DistFnData>::VisitFn visitFn,
+                                    void *visitData)
+        {
+            RangeNeighbors(qkey, range, visitFn, visitData, GetThreadQueryContext());
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Same as RangeNeighbors(qkey, range, visitFn, visitData), but using <tt>ctx</tt>
+         *       for the scratch state of the query.
+         */
+        virtual void RangeNeighbors(const Key qkey,
+                                    const double range,
+                                    typename Proximity<Key, DistFnData>::VisitFn visitFn,
+                                    void *visitData,
+                                    QueryContext & ctx)
+        {
+            EnsureConstructed();
+
+            ReadWriteLock::ReadGuard guard(m_rwLock);
+
+            // with a fixed radius the order in which subtrees are visited does not
+            // affect the pruning, so a plain stack replaces the priority scheduler
+            ctx.m_stack.clear();
+            ctx.m_stack.push_back(0);
+            while(ctx.m_stack.size() > 0)
+            {
+                const int node = ctx.m_stack.back();
+                ctx.m_stack.pop_back();
+                NodeRangeNeighbors(node, qkey, range, visitFn, visitData, ctx);
+            }
+        }
+
+    protected:
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Answer the query on the constructed tree; the caller should hold the read lock.
+         *
+         *@remarks
+         * - <tt>seed</tt> drives the order in which the children of each node are visited.
+         */
+        void DoNeighbors(ProximityQuery<Key>   & query,
+                         ProximityResults<Key> & results,
+                         const unsigned long long seed,
+                         QueryContext          & ctx) const
+        {
             const Key  qkey = query.GetKey();
-            InnerData *data = NULL;  
             double     r    = 0.0;
 
             results.Clear();
             results.SetNrNeighborsAndRange(query.GetNrNeighbors(), query.GetRange());
-            
-            m_root->Neighbors(this, qkey, results);
-            while(m_scheduler.size() > 0)
+
+            ctx.m_rng            = seed;
+            ctx.m_nrDistEvals    = 0;
+            ctx.m_maxNrDistEvals = query.GetMaxNrDistanceEvaluations();
+            ctx.m_shrink         = 1.0 / (1.0 + query.GetEpsilon());
+
+            NodeNeighbors(0, qkey, results, ctx);
+            while(ctx.m_scheduler.size() > 0 && ctx.m_nrDistEvals < ctx.m_maxNrDistEvals)
             {
-                r    = results.GetMaxDistance();
-                data = m_scheduler.top();
-                m_scheduler.pop();
-                
+                r = results.GetMaxDistance() * ctx.m_shrink;
+
+                const typename QueryContext::Scheduled top  = ctx.m_scheduler.top();
+                const Node                           & node = m_nodes[top.m_node];
+                ctx.m_scheduler.pop();
+
                 if(r != INFINITY &&
-                   (data->m_distToCenter > (data->m_maxRadius + r) ||
-                    data->m_distToCenter < (data->m_minRadius - r)))
+                   (top.m_distToCenter > (node.m_maxRadius + r) ||
+                    top.m_distToCenter < (node.m_minRadius - r)))
                     break;
-                data->m_child->Neighbors(this, qkey, results);
-            }            
-            ClearScheduler();
+                NodeNeighbors(top.m_node, qkey, results, ctx);
+            }
+            while(ctx.m_scheduler.size() > 0)
+                ctx.m_scheduler.pop();
+            results.SetNrDistanceEvaluations(ctx.m_nrDistEvals);
         }
-        
-    protected:
-        virtual void ClearScheduler(void)
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief A node of the tree.
+         *
+         *@remarks
+         * - <tt>m_center</tt>, <tt>m_minRadius</tt>, <tt>m_maxRadius</tt> describe the node as a child
+         *   of its parent: its pivot and the range of distances from the pivot to the other keys in the subtree.
+         * - An inner node has <tt>m_nrChildren</tt> children stored at <tt>m_nodes[m_firstChild]</tt>, ....
+         *   The distances from the pivot of child <tt>h</tt> to the keys in child <tt>i</tt> are within
+         *   <tt>m_ranges[m_ranges + 2 * (h * m_nrChildren + i)]</tt> (min) and the entry after it (max).
+         * - A leaf stores its <tt>m_nrKeys</tt> keys at <tt>m_leafKeys[m_bucket]</tt>, ....
+         */
+        struct Node
+        {
+            Key    m_center;
+            double m_minRadius;
+            double m_maxRadius;
+            int    m_degree;
+            int    m_firstChild;
+            int    m_nrChildren;
+            int    m_ranges;
+            int    m_bucket;
+            int    m_nrKeys;
+        };
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Node to be expanded together with its keys and seed.
+         */
+        struct Pending
+        {
+            int                m_node;
+            unsigned long long m_seed;
+            std::vector<Key>   m_keys;
+        };
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Scratch state used to partition the keys of a node.
+         *
+         *@remarks
+         * - <tt>m_dists[j * k + i]</tt> is the distance from the <tt>j</tt>th key to the <tt>i</tt>th center.
+         */
+        struct BuildContext
         {
-            while(m_scheduler.size() > 0)
-                m_scheduler.pop();            
+            std::vector<double> m_dists;
+            std::vector<int>    m_centers;
+            std::vector<double> m_minDists;
+        };
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return the query context of the calling thread.
+         */
+        static QueryContext& GetThreadQueryContext(void)
+        {
+            static thread_local QueryContext ctx;
+            return ctx;
         }
-        
-        virtual void EnsureDists(const int npoints)
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Construct the tree if it has not been constructed yet.
+         */
+        virtual void EnsureConstructed(void)
         {
-            if(npoints > m_cap_dists)
+            m_rwLock.LockRead();
+            const bool constructed = this->IsDataStructureConstructed();
+            m_rwLock.UnlockRead();
+
+            if(constructed == false)
             {
-                const int new_cap = 2 * npoints + 1;
-                m_dists = (double **) realloc(m_dists, new_cap * sizeof(double *));
-                for(int i = m_cap_dists; i < new_cap; i++)
-                    m_dists[i] = (double *) calloc(m_maxDegree, sizeof(double));
-                m_cap_dists = new_cap;
+                ReadWriteLock::WriteGuard guard(m_rwLock);
+                if(this->IsDataStructureConstructed() == false)
+                    DoConstructDataStructure();
             }
         }
 
-        virtual void KCenters(const int           nkeys,
-                              const Key * const   keys,
-                              const int           k,
-                              int * const         centers,
-                              double            **dists)
-        {
-            Key ckey;
-            
-            m_kcentersMinDists.resize(nkeys);
-            for(int j = 0; j < nkeys; j++)
-                m_kcentersMinDists[j] = INFINITY;
-            centers[0] = RandomUniformInteger(0, nkeys - 1);
-            for(int i = 1; i < k; i++)
+        virtual void ClearTree(void)
+        {
+            m_nodes.clear();
+            m_ranges.clear();
+            m_leafKeys.clear();
+            m_freeBuckets.clear();
+        }
+
+        virtual void DoConstructDataStructure(void)
+        {
+            std::vector<Key> keys(this->m_keys);
+
+            Proximity<Key,DistFnData>::ConstructDataStructure();
+
+            ClearTree();
+            m_nodes.reserve(2 * keys.size() / std::max(1, m_maxNrPtsInLeaf) + 1);
+            m_nodes.resize(1);
+            InitNode(m_nodes[0], m_mainDegree);
+            BuildSubtree(0, MixSeed(RandomUniformInteger(0, RANDOM_MAX - 1)), keys);
+        }
+
+        static void InitNode(Node & node, const int degree)
+        {
+            node.m_minRadius  = INFINITY;
+            node.m_maxRadius  =-INFINITY;
+            node.m_degree     = degree;
+            node.m_firstChild = -1;
+            node.m_nrChildren = 0;
+            node.m_ranges     = -1;
+            node.m_bucket     = -1;
+            node.m_nrKeys     = 0;
+        }
+
+        bool ShouldExpand(const int node, const int nkeys) const
+        {
+            return nkeys > m_maxNrPtsInLeaf && nkeys > m_nodes[node].m_degree;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Turn <tt>node</tt> into a leaf with the given keys.
+         */
+        void MakeLeaf(const int node, const std::vector<Key> & keys)
+        {
+            int bucket;
+
+            if(m_freeBuckets.size() > 0)
             {
-                double dmax = -INFINITY;
-                ckey = keys[centers[i - 1]];
-                for(int j = 0; j < nkeys; j++)
+                bucket = m_freeBuckets.back();
+                m_freeBuckets.pop_back();
+            }
+            else
+            {
+                bucket = m_leafKeys.size();
+                m_leafKeys.resize(bucket + m_bucketSize);
+            }
+            std::copy(keys.begin(), keys.end(), m_leafKeys.begin() + bucket);
+            m_nodes[node].m_bucket = bucket;
+            m_nodes[node].m_nrKeys = keys.size();
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Allocate the children of <tt>node</tt> and its block of pivot ranges.
+         */
+        void AllocateChildren(const int node)
+        {
+            const int degree = m_nodes[node].m_degree;
+            const int first  = m_nodes.size();
+            const int ranges = m_ranges.size();
+
+            m_nodes.resize(first + degree);
+            for(int i = 0; i < degree; ++i)
+                InitNode(m_nodes[first + i], 0);
+            m_ranges.resize(ranges + 2 * degree * degree);
+            for(int i = ranges; i < (int) m_ranges.size(); i += 2)
+            {
+                m_ranges[i]     = INFINITY;
+                m_ranges[i + 1] =-INFINITY;
+            }
+            m_nodes[node].m_firstChild = first;
+            m_nodes[node].m_nrChildren = degree;
+            m_nodes[node].m_ranges     = ranges;
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Build the subtree rooted at <tt>root</tt> from the given keys, one level at a time.
+         *
+         *@remarks
+         * - The nodes of a level are allocated on the calling thread, in order, before they are partitioned,
+         *   so the layout of the arrays does not depend on the number of threads.
+         * - A node with more than its share of the keys of the level is partitioned on the calling thread,
+         *   computing its k-centers distances in parallel. The other nodes of the level are partitioned
+         *   as independent tasks, each thread with its own BuildContext.
+         * - Each node uses only its own seed, so the resulting tree is the same as with one thread.
+         */
+        virtual void BuildSubtree(const int root, const unsigned long long seed, std::vector<Key> & keys)
+        {
+            const int            nrThreads = m_threadPool.GetNrThreads();
+            std::vector<Pending> level(1);
+            std::vector<Pending> next;
+            std::vector<int>     splits;
+            std::vector<int>     tasks;
+
+            if((int) m_threadBuildContexts.size() < nrThreads)
+                m_threadBuildContexts.resize(nrThreads);
+
+            level[0].m_node = root;
+            level[0].m_seed = seed;
+            level[0].m_keys.swap(keys);
+
+            while(level.size() > 0)
+            {
+                int total = 0;
+
+                next.clear();
+                splits.clear();
+                tasks.clear();
+                for(int i = 0; i < (int) level.size(); ++i)
+                    total += level[i].m_keys.size();
+                for(int i = 0; i < (int) level.size(); ++i)
                 {
-                    if((dists[j][i - 1] = this->m_distFn(keys[j], ckey, this->m_distFnData)) < m_kcentersMinDists[j])
-                        m_kcentersMinDists[j] = dists[j][i - 1];
-                    if(m_kcentersMinDists[j] > dmax)
+                    const int node = level[i].m_node;
+
+                    if(ShouldExpand(node, level[i].m_keys.size()) == false)
+                    {
+                        MakeLeaf(node, level[i].m_keys);
+                        continue;
+                    }
+
+                    AllocateChildren(node);
+                    splits.push_back(i);
+                    splits.push_back(next.size());
+                    for(int j = 0; j < m_nodes[node].m_nrChildren; ++j)
                     {
-                        centers[i] = j;
-                        dmax       = m_kcentersMinDists[j];
+                        next.push_back(Pending());
+                        next.back().m_node = m_nodes[node].m_firstChild + j;
+                        next.back().m_seed = MixSeed(level[i].m_seed + j + 1);
                     }
                 }
+
+                for(int s = 0; s < (int) splits.size(); s += 2)
+                {
+                    Pending & p = level[splits[s]];
+
+                    if(nrThreads > 1 && (int) p.m_keys.size() * nrThreads > total)
+                        Partition(p, &next[splits[s + 1]], p.m_seed % p.m_keys.size(), m_buildContext, true);
+                    else
+                        tasks.push_back(s);
+                }
+
+                auto fn = [this, &level, &next, &splits, &tasks](const int task, const int thread)
+                    {
+                        Pending & p = level[splits[tasks[task]]];
+                        Partition(p, &next[splits[tasks[task] + 1]], p.m_seed % p.m_keys.size(),
+                                  m_threadBuildContexts[thread], false);
+                    };
+
+                if(tasks.size() > 1)
+                    m_threadPool.Run(tasks.size(), fn);
+                else if(tasks.size() == 1)
+                    fn(0, 0);
+
+                level.swap(next);
             }
-            ckey = keys[centers[k - 1]];   
-            for(int j = 0; j < nkeys; j++)
-                dists[j][k - 1] = this->m_distFn(keys[j], ckey, this->m_distFnData);
         }
 
-        std::vector<double> m_kcentersMinDists;
-        
-
-        friend class Node;
-        
-        class Node;
-        
-        class InnerData
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Insert the key into the constructed tree.
+         */
+        virtual void InsertKey(const Key key)
         {
-        public:
-            InnerData(Node * const parent, const int indexInParent, const int degree)
+            int node = 0;
+
+            while(m_nodes[node].m_nrChildren > 0)
             {
-                m_minRange.resize(degree);
-                m_maxRange.resize(degree);
-                
-                m_minRadius = INFINITY;
-                m_maxRadius =-INFINITY;
+                const int  degree = m_nodes[node].m_nrChildren;
+                Node      *child  = &m_nodes[m_nodes[node].m_firstChild];
+                double    *ranges = &m_ranges[m_nodes[node].m_ranges];
+                double     dmin   = INFINITY;
+                int        imin   = -1;
+
+                m_insertDists.resize(degree);
+                for(int i = 0; i < degree; i++)
+                    if((m_insertDists[i] = this->m_distFn(key, child[i].m_center, this->m_distFnData)) < dmin)
+                    {
+                        dmin = m_insertDists[i];
+                        imin = i;
+                    }
+                if(dmin < child[imin].m_minRadius)
+                    child[imin].m_minRadius = dmin;
+                if(dmin > child[imin].m_maxRadius)
+                    child[imin].m_maxRadius = dmin;
                 for(int i = 0; i < degree; i++)
                 {
-                    m_minRange[i] = INFINITY;
-                    m_maxRange[i] =-INFINITY;       
+                    double *range = &ranges[2 * (i * degree + imin)];
+                    if(range[0] > m_insertDists[i])
+                        range[0] = m_insertDists[i];
+                    if(range[1] < m_insertDists[i])
+                        range[1] = m_insertDists[i];
                 }
-                m_child = new Node(parent, indexInParent);
+                node = m_nodes[node].m_firstChild + imin;
             }
 
-            virtual ~InnerData(void)
+            Node & leaf = m_nodes[node];
+
+            m_leafKeys[leaf.m_bucket + leaf.m_nrKeys] = key;
+            ++leaf.m_nrKeys;
+            if(ShouldExpand(node, leaf.m_nrKeys))
             {
-                if(m_child)
-                    delete m_child;
-            }
+                std::vector<Key> keys(m_leafKeys.begin() + leaf.m_bucket,
+                                      m_leafKeys.begin() + leaf.m_bucket + leaf.m_nrKeys);
 
-            Key          m_center;
-            double         m_minRadius;
-            double         m_maxRadius;
-            std::vector<double> m_minRange;
-            std::vector<double> m_maxRange;
-            double         m_distToCenter;
-            Node *m_child;        
-        };
+                m_freeBuckets.push_back(leaf.m_bucket);
+                leaf.m_bucket = -1;
+                leaf.m_nrKeys = 0;
+                BuildSubtree(node, MixSeed(RandomUniformInteger(0, RANDOM_MAX - 1)), keys);
+            }
+        }
 
-        class Node
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Select the centers among the keys of <tt>p</tt> and distribute the other keys
+         *       among the already allocated children, whose pending entries are <tt>children</tt>.
+         *
+         *@remarks
+         * - It only writes to the node of <tt>p</tt>, its children, its block of pivot ranges, and
+         *   <tt>children</tt>, so different nodes can be partitioned concurrently.
+         */
+        void Partition(Pending            & p,
+                       Pending * const      children,
+                       const int            first,
+                       BuildContext       & ctx,
+                       const bool           parallel)
         {
-        public:
-            Node(Node * const parent, const int indexInParent)
-            {
-                m_parent        = parent;
-                m_indexInParent = indexInParent;
-            }
+            const int   npoints = p.m_keys.size();
+            const int   k       = m_nodes[p.m_node].m_nrChildren;
+            Node       *child   = &m_nodes[m_nodes[p.m_node].m_firstChild];
+            double     *ranges  = &m_ranges[m_nodes[p.m_node].m_ranges];
+            const Key  *keys    = &(p.m_keys[0]);
+            int         cdegree = 0;
+            int         cindex  = 0;
 
-            virtual ~Node(void)
-            {
-                for(int i = 0; i < (int) m_inner.size(); i++)
-                    delete m_inner[i];    
-            }
-            
-            bool ShouldExpand(ProximityGNAT<Key, DistFnData> * const gnat) const
+            KCenters(npoints, keys, k, first, ctx, parallel);
+
+            const double *dists   = &(ctx.m_dists[0]);
+            const int    *centers = &(ctx.m_centers[0]);
+
+            for(int i = 0; i < k; i++)
+                child[i].m_center = keys[centers[i]];
+
+            for(int j = 0; j < npoints; j++)
             {
-                return (int) m_keys.size() > gnat->m_maxNrPtsInLeaf &&
-                       (int) m_keys.size() > m_degree;
+                const double *distsj = &dists[j * k];
+
+                cindex = 0;
+                for(int i = 1; i < k; i++)
+                    if(distsj[i] < distsj[cindex])
+                        cindex = i;
+
+                if(j != centers[cindex])
+                {
+                    children[cindex].m_keys.push_back(keys[j]);
+                    if(distsj[cindex] > child[cindex].m_maxRadius)
+                        child[cindex].m_maxRadius = distsj[cindex];
+                    if(distsj[cindex] < child[cindex].m_minRadius)
+                        child[cindex].m_minRadius = distsj[cindex];
+                }
+                for(int h = 0; h < k; h++)
+                {
+                    double *range = &ranges[2 * (h * k + cindex)];
+                    if(range[0] > distsj[h])
+                        range[0] = distsj[h];
+                    if(range[1] < distsj[h])
+                        range[1] = distsj[h];
+                }
             }
 
-            void Expand(ProximityGNAT<Key, DistFnData> * const gnat)
+            for(int i = 0; i < k; i++)
             {
-                m_inner.resize(m_degree);
-                for(int i = 0; i < m_degree; i++)
-                    m_inner[i] = new InnerData(this, i, m_degree);
-                Partition(gnat);
-                for(int i = 0; i < m_degree; i++)
-                    if(m_inner[i]->m_child->ShouldExpand(gnat))
-                        m_inner[i]->m_child->Expand(gnat);
+                cdegree = k * (int) (children[i].m_keys.size() / npoints);
+                if(cdegree > m_maxDegree)
+                    cdegree = m_maxDegree;
+                if(cdegree < m_minDegree)
+                    cdegree = m_minDegree;
+                child[i].m_degree = cdegree;
+
+                if(child[i].m_minRadius == INFINITY)
+                    child[i].m_minRadius = 0.0;
+                if(child[i].m_maxRadius == -INFINITY)
+                    child[i].m_maxRadius = 0.0;
             }
 
-            void Partition(ProximityGNAT<Key, DistFnData> * const gnat)
+            std::vector<Key>().swap(p.m_keys);
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return a well-mixed seed (splitmix64 finalizer) derived from <tt>x</tt>.
+         */
+        static unsigned long long MixSeed(unsigned long long x)
+        {
+            x += 0x9e3779b97f4a7c15ULL;
+            x  = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            x  = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+            return x ^ (x >> 31);
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Compute the distances from <tt>keys[from]</tt>, ..., <tt>keys[to - 1]</tt> to the center <tt>ckey</tt>
+         *       (column <tt>col</tt> of <tt>ctx.m_dists</tt>) and, if <tt>updateMin</tt>, the distances to the closest center.
+         *
+         *@remarks
+         * - Return the first key in the range that is farthest from its closest center and set <tt>dmax</tt> to that distance.
+         */
+        int KCentersColumn(const Key * const keys,
+                           const int         k,
+                           const int         col,
+                           const Key         ckey,
+                           const int         from,
+                           const int         to,
+                           const bool        updateMin,
+                           BuildContext    & ctx,
+                           double          & dmax) const
+        {
+            double *dists    = &(ctx.m_dists[0]);
+            double *minDists = &(ctx.m_minDists[0]);
+            int     imax     = -1;
+
+            dmax = -INFINITY;
+            for(int j = from; j < to; j++)
             {
-                const int   npoints = m_keys.size();
-                int         cdegree = 0;
-                int         cindex  = 0;
-                InnerData * data    = NULL;
-                
-                gnat->EnsureDists(npoints);     
-                
-                double **dists  = gnat->m_dists;
-                int     *centers= gnat->m_centers;
-                
-                gnat->KCenters(npoints, &(m_keys[0]),
-                               m_degree, centers, dists);
-                
-                for(int i = 0; i < m_degree; i++)
-                    m_inner[i]->m_center = m_keys[centers[i]];
-                
-                for(int j = 0; j < npoints; j++)
+                const double d = this->m_distFn(keys[j], ckey, this->m_distFnData);
+
+                dists[j * k + col] = d;
+                if(updateMin)
                 {
-                    cindex = 0;
-                    for(int i = 1; i < m_degree; i++)
-                        if(dists[j][i] < dists[j][cindex])
-                            cindex = i;
-                    data = m_inner[cindex];
-                    
-                    if(j != centers[cindex])
-                        data->m_child->m_keys.push_back(m_keys[j]);
-                    
-                    if(j != centers[cindex])
-                    {
-                        if(dists[j][cindex] > data->m_maxRadius)
-                            data->m_maxRadius = dists[j][cindex];
-                        if(dists[j][cindex] < data->m_minRadius)
-                            data->m_minRadius = dists[j][cindex];
-                    }
-                    for(int h = 0; h < m_degree; h++)
+                    if(d < minDists[j])
+                        minDists[j] = d;
+                    if(minDists[j] > dmax)
                     {
-                        if(m_inner[h]->m_minRange[cindex] > dists[j][h])
-                            m_inner[h]->m_minRange[cindex] = dists[j][h];
-                        if(m_inner[h]->m_maxRange[cindex] < dists[j][h])
-                            m_inner[h]->m_maxRange[cindex] = dists[j][h];
+                        imax = j;
+                        dmax = minDists[j];
                     }
                 }
-                
-                for(int i = 0; i < m_degree; i++)
-                {
-                    cdegree = m_degree * (int) (m_inner[i]->m_child->m_keys.size() / npoints);
-                    if(cdegree > gnat->m_maxDegree)
-                        cdegree = gnat->m_maxDegree;
-                    if(cdegree < gnat->m_minDegree)
-                        cdegree = gnat->m_minDegree;
-                    m_inner[i]->m_child->m_degree = cdegree;
-                    
-                    if(m_inner[i]->m_minRadius == INFINITY)
-                        m_inner[i]->m_minRadius = 0.0;
-                    if(m_inner[i]->m_maxRadius == -INFINITY)
-                        m_inner[i]->m_maxRadius = 0.0;
-                }
-                
-                m_keys.clear();
             }
+            return imax;
+        }
 
-            void InsertKey(ProximityGNAT<Key,DistFnData> * const gnat, const Key key)
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Select <tt>k</tt> centers among the keys by farthest-point traversal, starting from <tt>keys[first]</tt>.
+         *
+         *@remarks
+         * - The centers are stored in <tt>ctx.m_centers</tt> and the distances from the keys to the centers
+         *   in <tt>ctx.m_dists</tt>.
+         * - If <tt>parallel</tt> is true, each column of distances is split into chunks that are computed
+         *   by the thread pool. The farthest key is the first one in the best chunk, which is the same key
+         *   that the serial traversal selects.
+         */
+        virtual void KCenters(const int         nkeys,
+                              const Key * const keys,
+                              const int         k,
+                              const int         first,
+                              BuildContext    & ctx,
+                              const bool        parallel)
+        {
+            const int nrChunks = parallel ? std::min(nkeys, 4 * m_threadPool.GetNrThreads()) : 1;
+
+            ctx.m_dists.resize(nkeys * k);
+            ctx.m_centers.resize(k);
+            ctx.m_minDists.assign(nkeys, INFINITY);
+            if(parallel)
             {
-                const int degree = m_inner.size();
-                
-                if(degree == 0)
+                m_chunkMaxKeys.resize(nrChunks);
+                m_chunkMaxDists.resize(nrChunks);
+            }
+
+            ctx.m_centers[0] = first;
+            for(int i = 1; i <= k; i++)
+            {
+                const Key  ckey      = keys[ctx.m_centers[i - 1]];
+                const bool updateMin = i < k;
+
+                if(nrChunks == 1)
                 {
-                    m_keys.push_back(key);
-                    if(ShouldExpand(gnat))
-                        Expand(gnat);
+                    double dmax;
+                    const int imax = KCentersColumn(keys, k, i - 1, ckey, 0, nkeys, updateMin, ctx, dmax);
+                    if(updateMin)
+                        ctx.m_centers[i] = imax;
+                    continue;
                 }
-                else
+
+                m_threadPool.Run(nrChunks, [&](const int chunk, const int)
+                                 {
+                                     m_chunkMaxKeys[chunk] =
+                                         KCentersColumn(keys, k, i - 1, ckey,
+                                                        (int) (((long long) nkeys * chunk) / nrChunks),
+                                                        (int) (((long long) nkeys * (chunk + 1)) / nrChunks),
+                                                        updateMin, ctx, m_chunkMaxDists[chunk]);
+                                 });
+                if(updateMin)
                 {
-                    double        dmin       = INFINITY;
-                    int           imin       = -1;
-                    for(int i = 0; i < degree; i++)
-                        if((m_inner[i]->m_distToCenter = 
-                            gnat->m_distFn(key, m_inner[i]->m_center, gnat->m_distFnData)) < dmin)
+                    double dmax = -INFINITY;
+                    for(int c = 0; c < nrChunks; ++c)
+                        if(m_chunkMaxDists[c] > dmax)
                         {
-                            dmin = m_inner[i]->m_distToCenter;
-                            imin = i;
+                            ctx.m_centers[i] = m_chunkMaxKeys[c];
+                            dmax             = m_chunkMaxDists[c];
                         }
-                    if(dmin < m_inner[imin]->m_minRadius)
-                        m_inner[imin]->m_minRadius = dmin;
-                    if(dmin > m_inner[imin]->m_maxRadius)
-                        m_inner[imin]->m_maxRadius = dmin;
-                    for(int i = 0; i < degree; i++)
-                    {
-                        if(m_inner[i]->m_minRange[imin] > m_inner[i]->m_distToCenter)
-                            m_inner[i]->m_minRange[imin] = m_inner[i]->m_distToCenter;
-                        if(m_inner[i]->m_maxRange[imin] < m_inner[i]->m_distToCenter)
-                            m_inner[i]->m_maxRange[imin] = m_inner[i]->m_distToCenter;                
-                    }
-                    m_inner[imin]->m_child->InsertKey(gnat, key);            
                 }
             }
+        }
 
-            void Neighbors(ProximityGNAT<Key,DistFnData> * const    gnat, 
-                           const Key                                qkey, 
-                           ProximityResults<Key> &                  results)
+        void NodeNeighbors(const int                    id,
+                           const Key                    qkey,
+                           ProximityResults<Key>      & results,
+                           QueryContext               & ctx) const
+        {
+            const Node   & node   = m_nodes[id];
+            const int      degree = node.m_nrChildren;
+            double         r      = 0.0;
+
+            if(degree == 0)
             {
-                const int       size       = m_keys.size();
-                const int       degree     = m_inner.size();
-                int            *perm       = gnat->m_perm;
-                InnerData *     data       = NULL;
-                double          r          = 0.0;
-                
-                for(int i = 0; i < size; i++)
-                    results.Insert(m_keys[i], gnat->m_distFn(qkey, m_keys[i], gnat->m_distFnData));
-                
-                if(degree > 0)
+                const Key *keys = &m_leafKeys[node.m_bucket];
+                for(int i = 0; i < node.m_nrKeys && ctx.m_nrDistEvals < ctx.m_maxNrDistEvals; i++, ctx.m_nrDistEvals++)
+                    results.Insert(keys[i], this->m_distFn(qkey, keys[i], this->m_distFnData));
+                return;
+            }
+
+            const Node   *child  = &m_nodes[node.m_firstChild];
+            const double *ranges = &m_ranges[node.m_ranges];
+
+            ctx.m_perm.resize(degree);
+            ctx.m_distsToCenters.resize(degree);
+
+            int    *perm  = &(ctx.m_perm[0]);
+            double *dists = &(ctx.m_distsToCenters[0]);
+
+            // random visiting order from the generator of the query (64-bit LCG)
+            for(int z = 0; z < degree; ++z)
+                perm[z] = z;
+            for(int z = degree - 1; z > 0; --z)
+            {
+                ctx.m_rng = ctx.m_rng * 6364136223846793005ULL + 1442695040888963407ULL;
+                std::swap(perm[z], perm[(ctx.m_rng >> 33) % (z + 1)]);
+            }
+
+            for(int i = 0; i < degree; i++)
+                if(perm[i] >= 0)
                 {
-                    for(int z = 0; z < degree; ++z)
-                        perm[z] = z;
-                    PermuteItems<int>(degree, perm, degree);
-                    
-                    for(int i = 0; i < degree; i++)
-                        if(perm[i] >= 0)
-                        {
-                            data                 = m_inner[perm[i]];
-                            data->m_distToCenter = gnat->m_distFn(qkey, data->m_center, gnat->m_distFnData);
-                            results.Insert(data->m_center, data->m_distToCenter);
-                            if((r = results.GetMaxDistance()) != INFINITY)
-                                for(int j = 0; j < degree; j++)
-                                    if(perm[j] >= 0 && i != j &&
-                                       (data->m_distToCenter - r > data->m_maxRange[perm[j]] ||
-                                        data->m_distToCenter + r < data->m_minRange[perm[j]]))
-                                    {                        
-                                        perm[j] = -1;
-                                    }
-                        }
-                    
-                    r = results.GetMaxDistance();
-                    for(int i = 0; i < degree; i++)
-                        if(perm[i] >= 0)
-                        {
-                            data = m_inner[perm[i]];
-                            if(r == INFINITY ||
-                               (data->m_distToCenter <= (data->m_maxRadius + r) && 
-                                data->m_distToCenter >= (data->m_minRadius - r)))
-                                gnat->m_scheduler.push(data);
-                        }    
+                    const int     pi    = perm[i];
+                    const double *range = &ranges[2 * pi * degree];
+
+                    if(ctx.m_nrDistEvals >= ctx.m_maxNrDistEvals)
+                    {
+                        // out of budget: the remaining children are not evaluated
+                        for(int j = i; j < degree; j++)
+                            perm[j] = -1;
+                        break;
+                    }
+                    ++ctx.m_nrDistEvals;
+
+                    dists[pi] = this->m_distFn(qkey, child[pi].m_center, this->m_distFnData);
+                    results.Insert(child[pi].m_center, dists[pi]);
+                    if((r = results.GetMaxDistance() * ctx.m_shrink) != INFINITY)
+                        for(int j = 0; j < degree; j++)
+                            if(perm[j] >= 0 && i != j &&
+                               (dists[pi] - r > range[2 * perm[j] + 1] ||
+                                dists[pi] + r < range[2 * perm[j]]))
+                            {
+                                perm[j] = -1;
+                            }
                 }
-            }
 
-            Node *              m_parent;
-            int                 m_indexInParent;
-            int                 m_degree;
-            std::vector<Key>       m_keys;
-            std::vector<InnerData *> m_inner;
-        };
+            r = results.GetMaxDistance() * ctx.m_shrink;
+            for(int i = 0; i < degree; i++)
+                if(perm[i] >= 0)
+                {
+                    const int pi = perm[i];
+                    if(r == INFINITY ||
+                       (dists[pi] <= (child[pi].m_maxRadius + r) &&
+                        dists[pi] >= (child[pi].m_minRadius - r)))
+                    {
+                        typename QueryContext::Scheduled item;
 
-        struct LessFnInnerData : public std::binary_function<InnerData*, InnerData*, bool>
+                        item.m_node         = node.m_firstChild + pi;
+                        item.m_distToCenter = dists[pi];
+                        item.m_priority     = dists[pi] - child[pi].m_maxRadius;
+                        ctx.m_scheduler.push(item);
+                    }
+                }
+        }
+
+        void NodeRangeNeighbors(const int                                           id,
+                                const Key                                           qkey,
+                                const double                                        range,
+                                typename Proximity<Key, DistFnData>::VisitFn        visitFn,
+                                void                                               *visitData,
+                                QueryContext &                                      ctx) const
         {
-            bool operator()(InnerData* &a, InnerData* &b) const
+            const Node   & node   = m_nodes[id];
+            const int      degree = node.m_nrChildren;
+            double         d      = 0.0;
+
+            if(degree == 0)
             {
-                return (a->m_distToCenter - a->m_maxRadius) > (b->m_distToCenter - b->m_maxRadius);
+                const Key *keys = &m_leafKeys[node.m_bucket];
+                for(int i = 0; i < node.m_nrKeys; i++)
+                    if((d = this->m_distFn(qkey, keys[i], this->m_distFnData)) < range)
+                        visitFn(keys[i], d, visitData);
+                return;
             }
-        };
 
-        Node *      m_root;
-        int         m_mainDegree;
-        int         m_minDegree;
-        int         m_maxDegree;
-        int         m_maxNrPtsInLeaf;
-        int        *m_centers;
-        int        *m_perm;
-        double    **m_dists;        
-        int         m_cap_dists;
-        std::priority_queue<InnerData *, std::vector<InnerData *>, LessFnInnerData> m_scheduler;
-    };
-}
+            const Node   *child  = &m_nodes[node.m_firstChild];
+            const double *ranges = &m_ranges[node.m_ranges];
 
-#endif
+            ctx.m_perm.resize(degree);
+            ctx.m_distsToCenters.resize(degree);
 
+            int    *perm  = &(ctx.m_perm[0]);
+            double *dists = &(ctx.m_distsToCenters[0]);
 
+            for(int i = 0; i < degree; ++i)
+                perm[i] = i;
 
+            for(int i = 0; i < degree; i++)
+                if(perm[i] >= 0)
+                {
+                    const double *rangei = &ranges[2 * i * degree];
 
+                    dists[i] = this->m_distFn(qkey, child[i].m_center, this->m_distFnData);
+                    if(dists[i] < range)
+                        visitFn(child[i].m_center, dists[i], visitData);
+                    if(range != INFINITY)
+                        for(int j = 0; j < degree; j++)
+                            if(perm[j] >= 0 && i != j &&
+                               (dists[i] - range > rangei[2 * j + 1] ||
+                                dists[i] + range < rangei[2 * j]))
+                                perm[j] = -1;
+                }
 
+            for(int i = 0; i < degree; i++)
+                if(perm[i] >= 0)
+                {
+                    if(range == INFINITY ||
+                       (dists[i] <= (child[i].m_maxRadius + range) &&
+                        dists[i] >= (child[i].m_minRadius - range)))
+                        ctx.m_stack.push_back(node.m_firstChild + i);
+                }
+        }
 
+        int         m_mainDegree;
+        int         m_minDegree;
+        int         m_maxDegree;
+        int         m_maxNrPtsInLeaf;
+        int         m_bucketSize;
+        bool        m_bulkInsert;
+        ReadWriteLock m_rwLock;
+        std::mutex    m_batchMutex;
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Arena of the tree: nodes (the root is <tt>m_nodes[0]</tt>), pivot ranges,
+         *       leaf buckets of <tt>m_bucketSize</tt> keys each, and buckets freed by expanded leaves.
+         */
+        std::vector<Node>   m_nodes;
+        std::vector<double> m_ranges;
+        std::vector<Key>    m_leafKeys;
+        std::vector<int>    m_freeBuckets;
+        std::vector<double> m_insertDists;
 
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Threads and per-thread scratch state for building the tree.
+         *
+         *@remarks
+         * - <tt>m_buildContext</tt> is used by the calling thread for the nodes whose k-centers
+         *   distances are computed in parallel.
+         */
+        ThreadPool                m_threadPool;
+        BuildContext              m_buildContext;
+        std::vector<BuildContext> m_threadBuildContexts;
+        std::vector<int>          m_chunkMaxKeys;
+        std::vector<double>       m_chunkMaxDists;
+    };
+}
 
+#endif
@@ -2,6 +2,7 @@
 #define Antipatrea__ProximityQuery_HPP_
 
 #include <cmath>
+#include <climits>
 
 namespace Antipatrea
 {
@@ -11,8 +12,10 @@ namespace Antipatrea
     public:
         ProximityQuery(void)
         {
-            m_k       = 0;
-            m_range   = INFINITY;            
+            m_k                        = 0;
+            m_range                    = INFINITY;            
+            m_epsilon                  = 0.0;
+            m_maxNrDistanceEvaluations = INT_MAX;
         }
 
         virtual ~ProximityQuery(void) 
@@ -34,6 +37,24 @@ namespace Antipatrea
             return m_key;
         }
 
+        /**
+         *@brief Get the approximation factor: a neighbor at distance <tt>d</tt> may be reported
+         *       instead of one at distance less than <tt>d / (1 + epsilon)</tt>.
+         */
+        double GetEpsilon(void) const
+        {
+            return m_epsilon;
+        }
+
+        /**
+         *@brief Get the maximum number of distance evaluations, after which the query
+         *       stops and reports the best neighbors found so far.
+         */
+        int GetMaxNrDistanceEvaluations(void) const
+        {
+            return m_maxNrDistanceEvaluations;
+        }
+
         virtual void Clear(void)
         {
         }
@@ -54,10 +75,28 @@ namespace Antipatrea
             m_key = key;
         }
 
+        /**
+         *@brief Set the approximation factor (0 for exact queries).
+         */
+        virtual void SetEpsilon(const double epsilon)
+        {
+            m_epsilon = epsilon;
+        }
+
+        /**
+         *@brief Set the maximum number of distance evaluations (INT_MAX for no limit).
+         */
+        virtual void SetMaxNrDistanceEvaluations(const int n)
+        {
+            m_maxNrDistanceEvaluations = n;
+        }
+
    protected:
         int    m_k;
         double m_range;
         Key    m_key;
+        double m_epsilon;
+        int    m_maxNrDistanceEvaluations;
    };
 }
 
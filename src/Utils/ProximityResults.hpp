@@ -12,7 +12,8 @@ namespace Antipatrea
     public:
         ProximityResults(void)
         {
-            m_nrKeysInserted = 0;
+            m_nrKeysInserted         = 0;
+            m_nrDistanceEvaluations  = 0;
         }
         
         ~ProximityResults(void) 
@@ -44,6 +45,19 @@ namespace Antipatrea
             return m_nrKeysInserted < n ? m_nrKeysInserted : n;
         }
         
+        /**
+         *@brief Get the number of distance evaluations spent by the query that produced the results.
+         */
+        int GetNrDistanceEvaluations(void) const
+        {
+            return m_nrDistanceEvaluations;
+        }
+
+        void SetNrDistanceEvaluations(const int n)
+        {
+            m_nrDistanceEvaluations = n;
+        }
+        
         Key GetKey(const int i) const
         {
             return m_keys[i];
@@ -79,7 +93,8 @@ namespace Antipatrea
         
         void Clear(void)
         {
-            m_nrKeysInserted = 0;
+            m_nrKeysInserted        = 0;
+            m_nrDistanceEvaluations = 0;
             m_keys.clear();
             m_dists.clear();
         }
@@ -89,6 +104,7 @@ namespace Antipatrea
         std::vector<Key>    m_keys;
         std::vector<double> m_dists;
         int                 m_nrKeysInserted;
+        int                 m_nrDistanceEvaluations;
     };
 }
 
@@ -0,0 +1,522 @@
+#ifndef Antipatrea__ProximityTorus_HPP_
+#define Antipatrea__ProximityTorus_HPP_
+
+#include "Utils/Proximity.hpp"
+#include "Utils/Algebra2D.hpp"
+#include "Utils/ReadWriteLock.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace Antipatrea
+{
+    /**
+     *@author Erion Plaku, Amarda Shehu
+     *@brief Periodic kd-tree for nearest-neighbors queries when each key is a point on the torus
+     *       <tt>S^1 x ... x S^1</tt> and the distance is the Lp norm of the shortest arcs, i.e.,
+     *       the distance defined by CfgDistanceLp together with SignedDistanceBetweenTwoAngles.
+     *
+     *@remarks
+     * - Instead of calling the distance function, the tree gets the angles of a key through
+     *   <tt>m_valuesFn</tt>, normalizes them to <tt>[0, 2 pi)</tt>, and keeps a copy of them.
+     *   The angles of the keys in a leaf are stored one key after the other in a single array,
+     *   so the distances from a query to the keys of a leaf are computed by a tight loop over
+     *   contiguous values without any virtual calls, which the compiler can vectorize.
+     * - Each inner node splits the angles along one dimension. Since the angles are normalized,
+     *   the box of a node is an interval along each dimension, and the distance from a query angle
+     *   to the interval is measured around the circle, so subtrees across the wrap-around
+     *   point 0 = 2 pi are not missed.
+     * - Keys are inserted one at a time: a leaf with more than <tt>m_maxNrKeysInLeaf</tt> keys
+     *   is split at the median of the dimension with the largest spread. A leaf whose keys all have
+     *   the same angles cannot be split, so it doubles its own limit instead; otherwise every later
+     *   insertion into it would scan all its keys again.
+     * - Queries support the same approximation factor and budget of distance evaluations as ProximityGNAT.
+     * - Locking follows ProximityGNAT: queries hold a read lock and AddKey/ConstructDataStructure/ClearDataStructure
+     *   hold a write lock; the scratch state of a query is thread-local.
+     * - The dimension and the exponent of the Lp norm should be set (see SetDim and SetExponent) before adding keys.
+     */
+    template <typename Key, typename DistFnData>
+    class ProximityTorus : public Proximity<Key, DistFnData>
+    {
+    public:
+        /**
+         *@brief Function that returns the angles of a key.
+         */
+        typedef const double* (*ValuesFn) (const Key, DistFnData);
+
+        ProximityTorus(const int maxNrKeysInLeaf = 16) : Proximity<Key, DistFnData>()
+        {
+            m_valuesFn        = NULL;
+            m_dim             = 0;
+            m_exponent        = 2;
+            m_maxNrKeysInLeaf = maxNrKeysInLeaf;
+        }
+
+        virtual ~ProximityTorus(void)
+        {
+        }
+
+        ValuesFn m_valuesFn;
+
+        virtual int GetDim(void) const
+        {
+            return m_dim;
+        }
+
+        virtual void SetDim(const int dim)
+        {
+            m_dim = dim;
+        }
+
+        virtual int GetExponent(void) const
+        {
+            return m_exponent;
+        }
+
+        virtual void SetExponent(const int exponent)
+        {
+            m_exponent = exponent;
+        }
+
+        virtual void AddKey(const Key key)
+        {
+            ReadWriteLock::WriteGuard guard(m_rwLock);
+
+            Proximity<Key,DistFnData>::AddKey(key);
+            if(this->IsDataStructureConstructed())
+                InsertKey(key);
+        }
+
+        virtual void ClearDataStructure(void)
+        {
+            ReadWriteLock::WriteGuard guard(m_rwLock);
+
+            Proximity<Key,DistFnData>::ClearDataStructure();
+            m_nodes.clear();
+            m_leaves.clear();
+        }
+
+        virtual void ConstructDataStructure(void)
+        {
+            ReadWriteLock::WriteGuard guard(m_rwLock);
+
+            DoConstructDataStructure();
+        }
+
+        virtual void Neighbors(ProximityQuery<Key>   & query,
+                               ProximityResults<Key> & results)
+        {
+            EnsureConstructed();
+
+            ReadWriteLock::ReadGuard guard(m_rwLock);
+            QueryContext           & ctx = GetThreadQueryContext();
+            const double             r   = query.GetRange();
+
+            results.Clear();
+            results.SetNrNeighborsAndRange(query.GetNrNeighbors(), r);
+
+            SetupQuery(query.GetKey(), ctx);
+            ctx.m_results        = &results;
+            ctx.m_visitFn        = NULL;
+            ctx.m_nrDistEvals    = 0;
+            ctx.m_maxNrDistEvals = query.GetMaxNrDistanceEvaluations();
+            ctx.m_shrink         = Power(1.0 / (1.0 + query.GetEpsilon()));
+            Search(0, 0.0, ctx);
+            results.SetNrDistanceEvaluations(ctx.m_nrDistEvals);
+        }
+
+        virtual void RangeNeighbors(const Key qkey,
+                                    const double range,
+                                    typename Proximity<Key, DistFnData>::VisitFn visitFn,
+                                    void *visitData)
+        {
+            EnsureConstructed();
+
+            ReadWriteLock::ReadGuard guard(m_rwLock);
+            QueryContext           & ctx = GetThreadQueryContext();
+
+            SetupQuery(qkey, ctx);
+            ctx.m_results        = NULL;
+            ctx.m_range          = range;
+            ctx.m_visitFn        = visitFn;
+            ctx.m_visitData      = visitData;
+            ctx.m_nrDistEvals    = 0;
+            ctx.m_maxNrDistEvals = INT_MAX;
+            ctx.m_shrink         = 1.0;
+            Search(0, 0.0, ctx);
+        }
+
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief Return the Lp distance on the torus between the angles <tt>a</tt> and <tt>b</tt>,
+         *       which should have been normalized to <tt>[0, 2 pi)</tt>.
+         */
+        double Distance(const double a[], const double b[]) const
+        {
+            return Root(PowerDistance(a, b));
+        }
+
+    protected:
+        /**
+         *@author Erion Plaku, Amarda Shehu
+         *@brief A node of the tree; the root is <tt>m_nodes[0]</tt>.
+         *
+         *@remarks
+         * - An inner node splits its box along dimension <tt>m_dim</tt>, which spans
+         *   <tt>[m_lo, m_hi]</tt>, into <tt>[m_lo, m_split]</tt> (child <tt>m_child</tt>)
+         *   and <tt>[m_split, m_hi]</tt> (child <tt>m_child + 1</tt>).
+         * - A leaf has <tt>m_dim = -1</tt> and its keys are in <tt>m_leaves[m_leaf]</tt>.
+         */
+        struct Node
+        {
+            int    m_dim;
+            double m_split;
+            double m_lo;
+            double m_hi;
+            int    m_child;
+            int    m_leaf;
+        };
+
+        struct Leaf
+        {
+            Leaf(void) : m_maxNrKeys(0)
+            {
+            }
+
+            std::vector<Key>    m_keys;
+            std::vector<double> m_values;
+            int                 m_maxNrKeys; //raised limit after a failed split (0 if none)
+        };
+
+        struct QueryContext
+        {
+            std::vector<double>                           m_query;
+            std::vector<double>                           m_offsets;
+            ProximityResults<Key>                        *m_results;
+            double                                        m_range;
+            typename Proximity<Key, DistFnData>::VisitFn  m_visitFn;
+            void                                         *m_visitData;
+            int                                           m_nrDistEvals;
+            int                                           m_maxNrDistEvals;
+            double                                        m_shrink;
+        };
+
+        static QueryContext& GetThreadQueryContext(void)
+        {
+            static thread_local QueryContext ctx;
+            return ctx;
+        }
+
+        virtual void EnsureConstructed(void)
+        {
+            m_rwLock.LockRead();
+            const bool constructed = this->IsDataStructureConstructed();
+            m_rwLock.UnlockRead();
+
+            if(constructed == false)
+            {
+                ReadWriteLock::WriteGuard guard(m_rwLock);
+                if(this->IsDataStructureConstructed() == false)
+                    DoConstructDataStructure();
+            }
+        }
+
+        virtual void DoConstructDataStructure(void)
+        {
+            Proximity<Key,DistFnData>::ConstructDataStructure();
+
+            m_nodes.resize(1);
+            m_nodes[0].m_dim  = -1;
+            m_nodes[0].m_leaf = 0;
+            m_leaves.resize(1);
+            m_leaves[0].m_keys.clear();
+            m_leaves[0].m_values.clear();
+            m_leaves[0].m_maxNrKeys = 0;
+            for(int i = 0; i < (int) this->m_keys.size(); ++i)
+                InsertKey(this->m_keys[i]);
+        }
+
+        static double Normalize(const double theta)
+        {
+            const double a = Algebra2D::AngleNormalize(theta, 0.0);
+            return a >= 2 * M_PI ? 0.0 : a;
+        }
+
+        /**
+         *@brief Return the length of the shortest arc between two angles in <tt>[0, 2 pi)</tt>.
+         */
+        static double ArcLength(const double a, const double b)
+        {
+            const double d = fabs(a - b);
+            return std::min(d, 2 * M_PI - d);
+        }
+
+        /**
+         *@brief Return the length of the shortest arc from angle <tt>q</tt> to the interval <tt>[lo, hi]</tt>.
+         */
+        static double ArcLengthToInterval(const double q, const double lo, const double hi)
+        {
+            if(q >= lo && q <= hi)
+                return 0.0;
+            return std::min(ArcLength(q, lo), ArcLength(q, hi));
+        }
+
+        double Power(const double d) const
+        {
+            if(m_exponent == 2)
+                return d * d;
+            else if(m_exponent == 1)
+                return d;
+            return pow(d, m_exponent);
+        }
+
+        double Root(const double s) const
+        {
+            if(m_exponent == 2)
+                return sqrt(s);
+            else if(m_exponent == 1)
+                return s;
+            return pow(s, 1.0 / m_exponent);
+        }
+
+        /**
+         *@brief Return the sum of the p-th powers of the shortest arcs between <tt>a</tt> and <tt>b</tt>.
+         *
+         *@remarks
+         * - The common exponents have their own loops without calls to pow, so that they can be vectorized.
+         */
+        double PowerDistance(const double a[], const double b[]) const
+        {
+            const int dim = m_dim;
+            double    s   = 0.0;
+
+            if(m_exponent == 2)
+            {
+                for(int i = 0; i < dim; ++i)
+                {
+                    const double d = fabs(a[i] - b[i]);
+                    const double e = std::min(d, 2 * M_PI - d);
+                    s += e * e;
+                }
+            }
+            else if(m_exponent == 1)
+            {
+                for(int i = 0; i < dim; ++i)
+                {
+                    const double d = fabs(a[i] - b[i]);
+                    s += std::min(d, 2 * M_PI - d);
+                }
+            }
+            else
+            {
+                for(int i = 0; i < dim; ++i)
+                    s += pow(ArcLength(a[i], b[i]), m_exponent);
+            }
+            return s;
+        }
+
+        void SetupQuery(const Key qkey, QueryContext & ctx) const
+        {
+            const double *vals = m_valuesFn(qkey, this->m_distFnData);
+
+            ctx.m_query.resize(m_dim);
+            ctx.m_offsets.assign(m_dim, 0.0);
+            for(int i = 0; i < m_dim; ++i)
+                ctx.m_query[i] = Normalize(vals[i]);
+        }
+
+        virtual void InsertKey(const Key key)
+        {
+            const double *vals = m_valuesFn(key, this->m_distFnData);
+            int           node = 0;
+
+            m_lo.assign(m_dim, 0.0);
+            m_hi.assign(m_dim, 2 * M_PI);
+            m_insertValues.resize(m_dim);
+            for(int i = 0; i < m_dim; ++i)
+                m_insertValues[i] = Normalize(vals[i]);
+
+            while(m_nodes[node].m_dim >= 0)
+            {
+                const Node & n = m_nodes[node];
+
+                if(m_insertValues[n.m_dim] < n.m_split)
+                {
+                    m_hi[n.m_dim] = n.m_split;
+                    node          = n.m_child;
+                }
+                else
+                {
+                    m_lo[n.m_dim] = n.m_split;
+                    node          = n.m_child + 1;
+                }
+            }
+
+            Leaf & leaf = m_leaves[m_nodes[node].m_leaf];
+
+            leaf.m_keys.push_back(key);
+            leaf.m_values.insert(leaf.m_values.end(), m_insertValues.begin(), m_insertValues.end());
+            if((int) leaf.m_keys.size() > std::max(m_maxNrKeysInLeaf, leaf.m_maxNrKeys))
+                SplitLeaf(node);
+        }
+
+        /**
+         *@brief Split the leaf at the median of the dimension with the largest spread,
+         *       given the box of the leaf in <tt>m_lo</tt>, <tt>m_hi</tt>.
+         */
+        virtual void SplitLeaf(const int node)
+        {
+            const int     ileaf  = m_nodes[node].m_leaf;
+            const int     n      = m_leaves[ileaf].m_keys.size();
+            const double *values = &(m_leaves[ileaf].m_values[0]);
+            int           dim    = -1;
+            double        spread = 0.0;
+
+            for(int i = 0; i < m_dim; ++i)
+            {
+                double vmin = values[i];
+                double vmax = values[i];
+                for(int j = 1; j < n; ++j)
+                {
+                    vmin = std::min(vmin, values[j * m_dim + i]);
+                    vmax = std::max(vmax, values[j * m_dim + i]);
+                }
+                if(vmax - vmin > spread)
+                {
+                    spread = vmax - vmin;
+                    dim    = i;
+                }
+            }
+            if(dim < 0)
+            {
+                //all keys have the same angles: try again once the leaf has twice as many keys
+                m_leaves[ileaf].m_maxNrKeys = 2 * n;
+                return;
+            }
+
+            m_splitValues.resize(n);
+            for(int j = 0; j < n; ++j)
+                m_splitValues[j] = values[j * m_dim + dim];
+            std::nth_element(m_splitValues.begin(), m_splitValues.begin() + n / 2, m_splitValues.end());
+
+            double split = m_splitValues[n / 2];
+            if(split == *std::min_element(m_splitValues.begin(), m_splitValues.end()))
+            {
+                // the median is the smallest value: split above it so that both sides are nonempty
+                double next = INFINITY;
+                for(int j = 0; j < n; ++j)
+                    if(m_splitValues[j] > split && m_splitValues[j] < next)
+                        next = m_splitValues[j];
+                split = 0.5 * (split + next);
+            }
+
+            const int child = m_nodes.size();
+            Leaf      old;
+
+            old.m_keys.swap(m_leaves[ileaf].m_keys);
+            old.m_values.swap(m_leaves[ileaf].m_values);
+            m_leaves[ileaf].m_maxNrKeys = 0;
+
+            m_nodes.resize(child + 2);
+            m_nodes[child].m_dim      = -1;
+            m_nodes[child].m_leaf     = ileaf;
+            m_nodes[child + 1].m_dim  = -1;
+            m_nodes[child + 1].m_leaf = m_leaves.size();
+            m_leaves.resize(m_leaves.size() + 1);
+
+            Node & n0 = m_nodes[node];
+            n0.m_dim   = dim;
+            n0.m_split = split;
+            n0.m_lo    = m_lo[dim];
+            n0.m_hi    = m_hi[dim];
+            n0.m_child = child;
+            n0.m_leaf  = -1;
+
+            for(int j = 0; j < n; ++j)
+            {
+                Leaf & leaf = m_leaves[m_nodes[old.m_values[j * m_dim + dim] < split ? child : child + 1].m_leaf];
+                leaf.m_keys.push_back(old.m_keys[j]);
+                leaf.m_values.insert(leaf.m_values.end(),
+                                     old.m_values.begin() + j * m_dim,
+                                     old.m_values.begin() + (j + 1) * m_dim);
+            }
+        }
+
+        /**
+         *@brief Return the p-th power of the current search radius, shrunk by the approximation factor.
+         */
+        double SearchRadius(const QueryContext & ctx) const
+        {
+            const double r = ctx.m_results ? ctx.m_results->GetMaxDistance() : ctx.m_range;
+            return r == INFINITY ? INFINITY : Power(r) * ctx.m_shrink;
+        }
+
+        /**
+         *@brief Visit the subtree whose box is at distance <tt>rd</tt> (p-th power) from the query.
+         *
+         *@remarks
+         * - <tt>ctx.m_offsets[i]</tt> is the p-th power of the distance along dimension <tt>i</tt> from the query to the box.
+         */
+        void Search(const int id, const double rd, QueryContext & ctx) const
+        {
+            if(rd > SearchRadius(ctx) || ctx.m_nrDistEvals >= ctx.m_maxNrDistEvals)
+                return;
+
+            const Node & node = m_nodes[id];
+
+            if(node.m_dim < 0)
+            {
+                const Leaf   & leaf   = m_leaves[node.m_leaf];
+                const int      n      = leaf.m_keys.size();
+                const double  *values = n > 0 ? &(leaf.m_values[0]) : NULL;
+                const double  *q      = &(ctx.m_query[0]);
+
+                for(int j = 0; j < n && ctx.m_nrDistEvals < ctx.m_maxNrDistEvals; ++j, ++ctx.m_nrDistEvals)
+                {
+                    const double d = Root(PowerDistance(q, values + j * m_dim));
+                    if(ctx.m_results)
+                        ctx.m_results->Insert(leaf.m_keys[j], d);
+                    else if(d < ctx.m_range)
+                        ctx.m_visitFn(leaf.m_keys[j], d, ctx.m_visitData);
+                }
+                return;
+            }
+
+            const int    dim   = node.m_dim;
+            const double q     = ctx.m_query[dim];
+            const double old   = ctx.m_offsets[dim];
+            const double offLo = Power(ArcLengthToInterval(q, node.m_lo, node.m_split));
+            const double offHi = Power(ArcLengthToInterval(q, node.m_split, node.m_hi));
+            const double rdLo  = rd - old + offLo;
+            const double rdHi  = rd - old + offHi;
+
+            if(rdLo <= rdHi)
+            {
+                ctx.m_offsets[dim] = offLo;
+                Search(node.m_child, rdLo, ctx);
+                ctx.m_offsets[dim] = offHi;
+                Search(node.m_child + 1, rdHi, ctx);
+            }
+            else
+            {
+                ctx.m_offsets[dim] = offHi;
+                Search(node.m_child + 1, rdHi, ctx);
+                ctx.m_offsets[dim] = offLo;
+                Search(node.m_child, rdLo, ctx);
+            }
+            ctx.m_offsets[dim] = old;
+        }
+
+        int                 m_dim;
+        int                 m_exponent;
+        int                 m_maxNrKeysInLeaf;
+        std::vector<Node>   m_nodes;
+        std::vector<Leaf>   m_leaves;
+        std::vector<double> m_lo;
+        std::vector<double> m_hi;
+        std::vector<double> m_insertValues;
+        std::vector<double> m_splitValues;
+        ReadWriteLock       m_rwLock;
+    };
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef Antipatrea__ReadWriteLock_HPP_
+#define Antipatrea__ReadWriteLock_HPP_
+
+#include <mutex>
+#include <condition_variable>
+
+namespace Antipatrea
+{
+    /**
+     *@author Erion Plaku, Amarda Shehu
+     *@brief Lock that allows either many concurrent readers or a single writer.
+     *
+     *@remarks
+     * - A waiting writer blocks new readers, so that a steady stream of
+     *   queries cannot starve insertions.
+     * - It is not recursive: a thread that holds the lock should not acquire it again.
+     */
+    class ReadWriteLock
+    {
+    public:
+        ReadWriteLock(void) : m_nrReaders(0),
+                              m_nrWritersWaiting(0),
+                              m_writer(false)
+        {
+        }
+
+        virtual ~ReadWriteLock(void)
+        {
+        }
+
+        void LockRead(void)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cond.wait(lock, [this]{ return !m_writer && m_nrWritersWaiting == 0; });
+            ++m_nrReaders;
+        }
+
+        void UnlockRead(void)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(--m_nrReaders == 0)
+                m_cond.notify_all();
+        }
+
+        void LockWrite(void)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            ++m_nrWritersWaiting;
+            m_cond.wait(lock, [this]{ return !m_writer && m_nrReaders == 0; });
+            --m_nrWritersWaiting;
+            m_writer = true;
+        }
+
+        void UnlockWrite(void)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_writer = false;
+            m_cond.notify_all();
+        }
+
+        /**
+         *@brief Hold the read lock for the lifetime of the object.
+         */
+        class ReadGuard
+        {
+        public:
+            ReadGuard(ReadWriteLock & rw) : m_rw(rw)
+            {
+                m_rw.LockRead();
+            }
+
+            ~ReadGuard(void)
+            {
+                m_rw.UnlockRead();
+            }
+
+        protected:
+            ReadWriteLock & m_rw;
+        };
+
+        /**
+         *@brief Hold the write lock for the lifetime of the object.
+         */
+        class WriteGuard
+        {
+        public:
+            WriteGuard(ReadWriteLock & rw) : m_rw(rw)
+            {
+                m_rw.LockWrite();
+            }
+
+            ~WriteGuard(void)
+            {
+                m_rw.UnlockWrite();
+            }
+
+        protected:
+            ReadWriteLock & m_rw;
+        };
+
+    protected:
+        std::mutex              m_mutex;
+        std::condition_variable m_cond;
+        int                     m_nrReaders;
+        int                     m_nrWritersWaiting;
+        bool                    m_writer;
+    };
+}
+
+#endif
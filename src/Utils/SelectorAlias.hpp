@@ -0,0 +1,149 @@
+#ifndef Antipatrea__SelectorAlias_HPP_
+#define Antipatrea__SelectorAlias_HPP_
+
+#include "Utils/PseudoRandom.hpp"
+#include <vector>
+
+namespace Antipatrea
+{
+    /**
+     *@author Erion Plaku, Amarda Shehu
+     *@brief Given items <em>p1, p2, ..., pn</em> with fixed weights
+     *       <em>w1, w2, ..., wn</em>, select item <em>pi</em>
+     *       with probability <em>wi / (w1 + ... + wn)</em> in constant time
+     *
+     *@remarks
+     * - It uses the alias method (Vose's construction). Build divides the interval
+     *   <em>[0, n)</em> into <em>n</em> unit cells. Cell <em>i</em> belongs to item <em>i</em> up to
+     *   <tt>m_probs[i]</tt> and to item <tt>m_aliases[i]</tt> for the rest.
+     *   Select makes one random draw: the integer part gives the cell and the fractional part picks between
+     *   the cell's item and its alias.
+     * - Use it in place of Selector or SelectorArray when the weights do not change after setup.
+     *   Items are added with Insert, and Build must be called before Select. Insert after Build
+     *   requires another call to Build.
+     */
+    template <typename Key>
+    class SelectorAlias
+    {
+    public:
+        SelectorAlias(void)
+        {
+        }
+
+        virtual ~SelectorAlias(void)
+        {
+        }
+
+        int GetNrItems(void) const
+        {
+            return m_keys.size();
+        }
+
+        const Key& GetKey(const int slot) const
+        {
+            return m_keys[slot];
+        }
+
+        double GetWeight(const int slot) const
+        {
+            return m_weights[slot];
+        }
+
+        /**
+         *@brief Add the item and return its slot
+         */
+        int Insert(const Key & key, const double w)
+        {
+            m_keys.push_back(key);
+            m_weights.push_back(w);
+
+            return m_keys.size() - 1;
+        }
+
+        /**
+         *@brief Build the alias table from the weights of the items
+         *
+         *@remarks
+         * - If all the weights are zero, the items are selected uniformly at random.
+         */
+        void Build(void)
+        {
+            const int        n     = m_keys.size();
+            double           total = 0.0;
+            std::vector<int> small;
+            std::vector<int> large;
+
+            m_probs.resize(n);
+            m_aliases.resize(n);
+
+            for(int i = 0; i < n; ++i)
+                total += m_weights[i];
+
+            for(int i = 0; i < n; ++i)
+            {
+                m_probs[i]   = total > 0.0 ? n * m_weights[i] / total : 1.0;
+                m_aliases[i] = i;
+                if(m_probs[i] < 1.0)
+                    small.push_back(i);
+                else
+                    large.push_back(i);
+            }
+
+            while(!small.empty() && !large.empty())
+            {
+                const int s = small.back();
+                const int l = large.back();
+
+                small.pop_back();
+                m_aliases[s] = l;
+                m_probs[l] -= 1.0 - m_probs[s];
+                if(m_probs[l] < 1.0)
+                {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+
+            // the remaining cells are full up to rounding errors
+            for(auto & i : small)
+                m_probs[i] = 1.0;
+            for(auto & i : large)
+                m_probs[i] = 1.0;
+        }
+
+        /**
+         *@brief Select an item and return its slot or <tt>-1</tt> if there are no items
+         */
+        int Select(void) const
+        {
+            const int n = m_probs.size();
+
+            if(n == 0)
+                return -1;
+
+            const double u    = n * RandomUniformReal();
+            const int    cell = u >= n ? n - 1 : (int) u;
+
+            return (u - cell) < m_probs[cell] ? cell : m_aliases[cell];
+        }
+
+        /**
+         *@brief Remove all the items
+         */
+        void Clear(void)
+        {
+            m_keys.clear();
+            m_weights.clear();
+            m_probs.clear();
+            m_aliases.clear();
+        }
+
+    protected:
+        std::vector<Key>    m_keys;
+        std::vector<double> m_weights;
+        std::vector<double> m_probs;
+        std::vector<int>    m_aliases;
+    };
+}
+
+#endif
@@ -0,0 +1,273 @@
+#ifndef Antipatrea__SelectorArray_HPP_
+#define Antipatrea__SelectorArray_HPP_
+
+#include "Utils/PseudoRandom.hpp"
+#include <cassert>
+#include <unordered_map>
+#include <vector>
+
+namespace Antipatrea
+{
+    /**
+     *@author Erion Plaku, Amarda Shehu
+     *@brief Given items <em>p1, p2, ..., pn</em> with weights
+     *       <em>w1, w2, ..., wn</em>, select item <em>pi</em>
+     *       with probability <em>wi / (w1 + ... + wn)</em>
+     *
+     *@remarks
+     * - It offers the same functionality as Selector, but the binary tree is implicit.
+     *   The tree is stored in one array, where node <em>i</em> has children <em>2i</em> and <em>2i+1</em>.
+     *   Each internal node stores the sum of the weights of its children, and the leaves store the item weights.
+     *   The leaves are contiguous in memory.
+     * - Each item is identified by its slot, which is returned by Insert and does not change until the item is removed.
+     *   Slots of removed items are reused by later insertions.
+     * - If the constructor is given <tt>indexKeys = true</tt>, Find(key) uses a hash map from keys to slots,
+     *   so it takes constant time. If several items have the same key, Find returns the slot of the one inserted last.
+     *   The map is not kept otherwise, since most users remember the slots returned by Insert.
+     * - Insert, Update, Remove, and Select take logarithmic time.
+     *   SetWeight followed by Rebuild, or Reweight, change many weights in linear time.
+     * - The sums are recomputed from the children rather than adjusted by the change in weight,
+     *   so rounding errors do not accumulate over many updates.
+     */
+    template <typename Key>
+    class SelectorArray
+    {
+    public:
+        SelectorArray(const bool indexKeys = false) : m_indexKeys(indexKeys),
+                                                      m_nrLeaves(0),
+                                                      m_nrItems(0)
+        {
+        }
+
+        virtual ~SelectorArray(void)
+        {
+        }
+
+        int GetNrItems(void) const
+        {
+            return m_nrItems;
+        }
+
+        double GetTotalWeight(void) const
+        {
+            return m_nrLeaves > 0 ? m_tree[1] : 0.0;
+        }
+
+        const Key& GetKey(const int slot) const
+        {
+            return m_keys[slot];
+        }
+
+        double GetWeight(const int slot) const
+        {
+            return m_tree[m_nrLeaves + slot];
+        }
+
+        /**
+         *@brief Get the slot of the item with the given key or <tt>-1</tt> if there is no such item
+         *
+         *@remarks
+         * - It requires the keys to be indexed (see the constructor).
+         */
+        int Find(const Key & key) const
+        {
+            assert(m_indexKeys);
+
+            auto cur = m_slots.find(key);
+
+            return cur == m_slots.end() ? -1 : cur->second;
+        }
+
+        /**
+         *@brief Insert the item and return its slot
+         */
+        int Insert(const Key & key, const double w)
+        {
+            int slot;
+
+            if(!m_free.empty())
+            {
+                slot = m_free.back();
+                m_free.pop_back();
+                m_keys[slot] = key;
+            }
+            else
+            {
+                slot = m_keys.size();
+                if(slot >= m_nrLeaves)
+                    Grow();
+                m_keys.push_back(key);
+                m_used.push_back(false);
+            }
+            m_used[slot] = true;
+            ++m_nrItems;
+            if(m_indexKeys)
+                m_slots[key] = slot;
+            Update(slot, w);
+
+            return slot;
+        }
+
+        /**
+         *@brief Set the weight of the item and update the sums
+         */
+        void Update(const int slot, const double w)
+        {
+            int i = m_nrLeaves + slot;
+
+            m_tree[i] = w;
+            for(i >>= 1; i >= 1; i >>= 1)
+                m_tree[i] = m_tree[2 * i] + m_tree[2 * i + 1];
+        }
+
+        /**
+         *@brief Set the weight of the item without updating the sums
+         *
+         *@remarks
+         * - Rebuild should be called after all the weights have been set.
+         */
+        void SetWeight(const int slot, const double w)
+        {
+            m_tree[m_nrLeaves + slot] = w;
+        }
+
+        /**
+         *@brief Recompute all the sums from the item weights
+         */
+        void Rebuild(void)
+        {
+            for(int i = m_nrLeaves - 1; i >= 1; --i)
+                m_tree[i] = m_tree[2 * i] + m_tree[2 * i + 1];
+        }
+
+        /**
+         *@brief Set the weight of each item to <tt>fn(key, weight)</tt> and recompute the sums
+         *
+         *@remarks
+         * - Slots of removed items keep their zero weight.
+         */
+        template <typename Fn>
+        void Reweight(Fn fn)
+        {
+            const int n = m_keys.size();
+
+            for(int slot = 0; slot < n; ++slot)
+                if(m_used[slot])
+                    m_tree[m_nrLeaves + slot] = fn(m_keys[slot], m_tree[m_nrLeaves + slot]);
+            Rebuild();
+        }
+
+        /**
+         *@brief Remove the item
+         */
+        void Remove(const int slot)
+        {
+            if(m_indexKeys)
+            {
+                auto cur = m_slots.find(m_keys[slot]);
+
+                if(cur != m_slots.end() && cur->second == slot)
+                    m_slots.erase(cur);
+            }
+            Update(slot, 0.0);
+            m_used[slot] = false;
+            m_free.push_back(slot);
+            --m_nrItems;
+        }
+
+        /**
+         *@brief Select an item and return its slot or <tt>-1</tt> if there are no items
+         */
+        int Select(void) const
+        {
+            return Select(RandomUniformReal(0, GetTotalWeight()));
+        }
+
+        /**
+         *@brief Select the item whose weight interval contains <em>wselect</em>
+         *
+         *@param wselect selection weight between <em>0</em> and <em>w1 + ... + wn</em>
+         *
+         *@remarks
+         * - Items with zero weight are selected only when all the weights are zero.
+         *   In that case, an item is selected uniformly at random, regardless of <em>wselect</em>.
+         */
+        int Select(const double wselect) const
+        {
+            if(m_nrItems == 0)
+                return -1;
+            if(GetTotalWeight() <= 0.0)
+                return SelectUniform();
+
+            double w = wselect;
+            int    i = 1;
+
+            while(i < m_nrLeaves)
+            {
+                const int left = 2 * i;
+
+                if(w < m_tree[left] || m_tree[left + 1] <= 0.0)
+                    i = left;
+                else
+                {
+                    w -= m_tree[left];
+                    i  = left + 1;
+                }
+            }
+            return i - m_nrLeaves;
+        }
+
+        /**
+         *@brief Remove all the items
+         */
+        void Clear(void)
+        {
+            m_nrLeaves = 0;
+            m_nrItems  = 0;
+            m_tree.clear();
+            m_keys.clear();
+            m_used.clear();
+            m_free.clear();
+            m_slots.clear();
+        }
+
+    protected:
+        /**
+         *@brief Select one of the items uniformly at random, skipping the slots of removed items
+         */
+        int SelectUniform(void) const
+        {
+            const int n = m_keys.size();
+            int       slot;
+
+            do
+                slot = RandomUniformInteger(0, n - 1);
+            while(!m_used[slot]);
+
+            return slot;
+        }
+
+        void Grow(void)
+        {
+            const int           nrLeaves = m_nrLeaves == 0 ? 1 : 2 * m_nrLeaves;
+            std::vector<double> tree(2 * nrLeaves, 0.0);
+
+            for(int slot = 0; slot < m_nrLeaves; ++slot)
+                tree[nrLeaves + slot] = m_tree[m_nrLeaves + slot];
+            m_tree.swap(tree);
+            m_nrLeaves = nrLeaves;
+            Rebuild();
+        }
+
+        bool                         m_indexKeys;
+        int                          m_nrLeaves;
+        int                          m_nrItems;
+        std::vector<double>          m_tree;
+        std::vector<Key>             m_keys;
+        std::vector<char>            m_used;
+        std::vector<int>             m_free;
+        std::unordered_map<Key, int> m_slots;
+    };
+}
+
+#endif
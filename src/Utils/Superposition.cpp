@@ -0,0 +1,181 @@
+#include "Utils/Superposition.hpp"
+#include <cmath>
+
+namespace Antipatrea
+{
+    namespace Superposition
+    {
+        void CenterCoords(const int n, double coords[])
+        {
+            double *x = coords;
+            double *y = coords + n;
+            double *z = coords + 2 * n;
+            double  cx = 0.0;
+            double  cy = 0.0;
+            double  cz = 0.0;
+
+            for(int i = 0; i < n; ++i)
+            {
+                cx += x[i];
+                cy += y[i];
+                cz += z[i];
+            }
+            cx /= n;
+            cy /= n;
+            cz /= n;
+
+            for(int i = 0; i < n; ++i)
+            {
+                x[i] -= cx;
+                y[i] -= cy;
+                z[i] -= cz;
+            }
+        }
+
+        double InnerProduct(const int n, const double coords[])
+        {
+            double g = 0.0;
+
+            for(int i = 3 * n - 1; i >= 0; --i)
+                g += coords[i] * coords[i];
+            return g;
+        }
+
+        void Covariance(const int n, const double A[], const double B[], double M[])
+        {
+            const double *xa = A;
+            const double *ya = A + n;
+            const double *za = A + 2 * n;
+            const double *xb = B;
+            const double *yb = B + n;
+            const double *zb = B + 2 * n;
+            double        sxx = 0.0, sxy = 0.0, sxz = 0.0;
+            double        syx = 0.0, syy = 0.0, syz = 0.0;
+            double        szx = 0.0, szy = 0.0, szz = 0.0;
+
+            for(int i = 0; i < n; ++i)
+            {
+                sxx += xa[i] * xb[i]; sxy += xa[i] * yb[i]; sxz += xa[i] * zb[i];
+                syx += ya[i] * xb[i]; syy += ya[i] * yb[i]; syz += ya[i] * zb[i];
+                szx += za[i] * xb[i]; szy += za[i] * yb[i]; szz += za[i] * zb[i];
+            }
+
+            M[0] = sxx; M[1] = sxy; M[2] = sxz;
+            M[3] = syx; M[4] = syy; M[5] = syz;
+            M[6] = szx; M[7] = szy; M[8] = szz;
+        }
+
+        double QCPRMSDFromCovariance(const int n, const double M[], const double GA, const double GB)
+        {
+            const double Sxx = M[0], Sxy = M[1], Sxz = M[2];
+            const double Syx = M[3], Syy = M[4], Syz = M[5];
+            const double Szx = M[6], Szy = M[7], Szz = M[8];
+
+            const double Sxx2 = Sxx * Sxx, Syy2 = Syy * Syy, Szz2 = Szz * Szz;
+            const double Sxy2 = Sxy * Sxy, Syz2 = Syz * Syz, Sxz2 = Sxz * Sxz;
+            const double Syx2 = Syx * Syx, Szy2 = Szy * Szy, Szx2 = Szx * Szx;
+
+            const double SyzSzymSyySzz2      = 2.0 * (Syz * Szy - Syy * Szz);
+            const double Sxx2Syy2Szz2Syz2Szy2 = Syy2 + Szz2 - Sxx2 + Syz2 + Szy2;
+            const double Sxy2Sxz2Syx2Szx2     = Sxy2 + Sxz2 - Syx2 - Szx2;
+
+            const double SxzpSzx = Sxz + Szx;
+            const double SyzpSzy = Syz + Szy;
+            const double SxypSyx = Sxy + Syx;
+            const double SyzmSzy = Syz - Szy;
+            const double SxzmSzx = Sxz - Szx;
+            const double SxymSyx = Sxy - Syx;
+            const double SxxpSyy = Sxx + Syy;
+            const double SxxmSyy = Sxx - Syy;
+
+            // coefficients of the characteristic polynomial x^4 + c2 x^2 + c1 x + c0
+            const double c2 = -2.0 * (Sxx2 + Syy2 + Szz2 + Sxy2 + Syx2 + Sxz2 + Szx2 + Syz2 + Szy2);
+            const double c1 =  8.0 * (Sxx * Syz * Szy + Syy * Szx * Sxz + Szz * Sxy * Syx -
+                                      Sxx * Syy * Szz - Syz * Szx * Sxy - Szy * Syx * Sxz);
+            const double c0 =
+                Sxy2Sxz2Syx2Szx2 * Sxy2Sxz2Syx2Szx2 +
+                (Sxx2Syy2Szz2Syz2Szy2 + SyzSzymSyySzz2) * (Sxx2Syy2Szz2Syz2Szy2 - SyzSzymSyySzz2) +
+                (-SxzpSzx * SyzmSzy + SxymSyx * (SxxmSyy - Szz)) * (-SxzmSzx * SyzpSzy + SxymSyx * (SxxmSyy + Szz)) +
+                (-SxzpSzx * SyzpSzy - SxypSyx * (SxxpSyy - Szz)) * (-SxzmSzx * SyzmSzy - SxypSyx * (SxxpSyy + Szz)) +
+                ( SxypSyx * SyzpSzy + SxzpSzx * (SxxmSyy + Szz)) * (-SxymSyx * SyzmSzy + SxzpSzx * (SxxpSyy + Szz)) +
+                ( SxypSyx * SyzmSzy + SxzmSzx * (SxxmSyy - Szz)) * (-SxymSyx * SyzpSzy + SxzmSzx * (SxxpSyy - Szz));
+
+            // Newton-Raphson for the largest root, starting from its upper bound (GA + GB) / 2
+            const double E0      = 0.5 * (GA + GB);
+            const double evalPrec = 1e-11;
+            double       lambda  = E0;
+
+            for(int i = 0; i < 50; ++i)
+            {
+                const double old = lambda;
+                const double x2  = lambda * lambda;
+                const double b   = (x2 + c2) * lambda;
+                const double a   = b + c1;
+                const double den = 2.0 * x2 * lambda + b + a;
+
+                if(den == 0.0)
+                    break;
+                lambda -= (a * lambda + c0) / den;
+                if(fabs(lambda - old) < fabs(evalPrec * lambda))
+                    break;
+            }
+
+            return sqrt(fabs(2.0 * (E0 - lambda) / n));
+        }
+
+        double QCPRMSD(const int n,
+                       const double A[], const double GA,
+                       const double B[], const double GB)
+        {
+            double M[9];
+
+            Covariance(n, A, B, M);
+            return QCPRMSDFromCovariance(n, M, GA, GB);
+        }
+
+        void QCPRMSDs(const int n,
+                      const double A[], const double GA,
+                      const int m,
+                      const double * const Bs[], const double GBs[],
+                      double rmsds[])
+        {
+            const double *xa = A;
+            const double *ya = A + n;
+            const double *za = A + 2 * n;
+            int           j  = 0;
+
+            // accumulate the covariances of four structures per pass so that each
+            // query coordinate is loaded once and reused across the block
+            for(; j + 4 <= m; j += 4)
+            {
+                double        S[4][9] = {};
+                const double *B[4]    = {Bs[j], Bs[j + 1], Bs[j + 2], Bs[j + 3]};
+
+                for(int i = 0; i < n; ++i)
+                {
+                    const double x = xa[i];
+                    const double y = ya[i];
+                    const double z = za[i];
+
+                    for(int k = 0; k < 4; ++k)
+                    {
+                        const double xb = B[k][i];
+                        const double yb = B[k][n + i];
+                        const double zb = B[k][2 * n + i];
+                        double      *s  = S[k];
+
+                        s[0] += x * xb; s[1] += x * yb; s[2] += x * zb;
+                        s[3] += y * xb; s[4] += y * yb; s[5] += y * zb;
+                        s[6] += z * xb; s[7] += z * yb; s[8] += z * zb;
+                    }
+                }
+
+                for(int k = 0; k < 4; ++k)
+                    rmsds[j + k] = QCPRMSDFromCovariance(n, S[k], GA, GBs[j + k]);
+            }
+
+            for(; j < m; ++j)
+                rmsds[j] = QCPRMSD(n, A, GA, Bs[j], GBs[j]);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef Antipatrea__Superposition_HPP_
+#define Antipatrea__Superposition_HPP_
+
+namespace Antipatrea
+{
+    /**
+     *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+     *@brief Least root mean square deviation (RMSD) between two sets of points
+     *       under optimal superposition.
+     *
+     *@remarks
+     * - The RMSD is computed with the quaternion characteristic polynomial (QCP) method
+     *   (Theobald, Acta Cryst A 2005; Liu, Agrafiotis, Theobald, J Comput Chem 2010):
+     *   the largest eigenvalue of the 4x4 key matrix is found via Newton-Raphson on its
+     *   characteristic polynomial, so no SVD or explicit rotation of the points is needed.
+     * - A set of <tt>n</tt> points is stored in structure-of-arrays layout,
+     *   i.e., x0 ... x(n-1) y0 ... y(n-1) z0 ... z(n-1), so that the covariance
+     *   accumulation runs over contiguous arrays and can be vectorized.
+     * - The QCP functions expect points that have been centered at the origin (see CenterCoords) together
+     *   with their inner product (see InnerProduct). These can be computed once per set of points and
+     *   reused for every comparison.
+     */
+    namespace Superposition
+    {
+        /**
+         *@brief Translate the <tt>n</tt> points so that their center of mass is at the origin.
+         */
+        void CenterCoords(const int n, double coords[]);
+
+        /**
+         *@brief Return the inner product of the <tt>n</tt> points, i.e., the sum of their squared norms.
+         */
+        double InnerProduct(const int n, const double coords[]);
+
+        /**
+         *@brief Compute the 3x3 covariance matrix <tt>M</tt> (row major) between the <tt>n</tt> points
+         *       <tt>A</tt> and <tt>B</tt>, i.e., M[3 * i + j] = sum_k A_i[k] * B_j[k].
+         */
+        void Covariance(const int n, const double A[], const double B[], double M[]);
+
+        /**
+         *@brief Return the RMSD given the covariance matrix <tt>M</tt> between two sets of <tt>n</tt> centered
+         *       points whose inner products are <tt>GA</tt> and <tt>GB</tt>.
+         */
+        double QCPRMSDFromCovariance(const int n, const double M[], const double GA, const double GB);
+
+        /**
+         *@brief Return the RMSD between the <tt>n</tt> centered points <tt>A</tt> and <tt>B</tt>
+         *       whose inner products are <tt>GA</tt> and <tt>GB</tt>.
+         */
+        double QCPRMSD(const int n,
+                       const double A[], const double GA,
+                       const double B[], const double GB);
+
+        /**
+         *@brief Compute the RMSD between the <tt>n</tt> centered points <tt>A</tt> (with inner product <tt>GA</tt>)
+         *       and each of the <tt>m</tt> sets of centered points <tt>Bs[i]</tt> (with inner product <tt>GBs[i]</tt>).
+         *
+         *@remarks
+         * - The result for <tt>Bs[i]</tt> is stored in <tt>rmsds[i]</tt>.
+         */
+        void QCPRMSDs(const int n,
+                      const double A[], const double GA,
+                      const int m,
+                      const double * const Bs[], const double GBs[],
+                      double rmsds[]);
+    }
+}
+
+#endif
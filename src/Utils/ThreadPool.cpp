@@ -0,0 +1,100 @@
+#include "Utils/ThreadPool.hpp"
+
+namespace Antipatrea
+{
+    ThreadPool::ThreadPool(void) : m_fn(NULL),
+                                   m_nrTasks(0),
+                                   m_nextTask(0),
+                                   m_nrBusy(0),
+                                   m_batch(0),
+                                   m_stop(false)
+    {
+    }
+
+    ThreadPool::~ThreadPool(void)
+    {
+        StopWorkers();
+    }
+
+    void ThreadPool::StopWorkers(void)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_start.notify_all();
+        for(auto & worker : m_workers)
+            worker.join();
+        m_workers.clear();
+        m_stop  = false;
+
+        //new workers start waiting for batch 1, so that they do not skip the next batch
+        m_batch = 0;
+    }
+
+    void ThreadPool::SetNrThreads(const int nrThreads)
+    {
+        if(nrThreads == GetNrThreads())
+            return;
+
+        StopWorkers();
+        for(int i = 1; i < nrThreads; ++i)
+            m_workers.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+    }
+
+    void ThreadPool::RunTasks(const int thread)
+    {
+        for(int task = m_nextTask++; task < m_nrTasks; task = m_nextTask++)
+            (*m_fn)(task, thread);
+    }
+
+    void ThreadPool::WorkerLoop(const int thread)
+    {
+        unsigned long batch = 0;
+
+        while(true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_start.wait(lock, [&]{ return m_stop || m_batch != batch; });
+                if(m_stop)
+                    return;
+                batch = m_batch;
+            }
+
+            RunTasks(thread);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(--m_nrBusy == 0)
+                    m_done.notify_one();
+            }
+        }
+    }
+
+    void ThreadPool::Run(const int nrTasks, const TaskFn & fn)
+    {
+        if(m_workers.empty() || nrTasks <= 1)
+        {
+            for(int task = 0; task < nrTasks; ++task)
+                fn(task, 0);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_fn       = &fn;
+            m_nrTasks  = nrTasks;
+            m_nextTask = 0;
+            m_nrBusy   = m_workers.size();
+            ++m_batch;
+        }
+        m_start.notify_all();
+
+        RunTasks(0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&]{ return m_nrBusy == 0; });
+        m_fn = NULL;
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef Antipatrea__ThreadPool_HPP_
+#define Antipatrea__ThreadPool_HPP_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+namespace Antipatrea
+{
+    /**
+     *@author Kevin Molloy, Erion Plaku, Amarda Shehu
+     *@brief Fixed set of worker threads that run batches of independent tasks.
+     *
+     *@remarks
+     * - The threads are created once (see SetNrThreads) and reused by every call to Run,
+     *   so that running a small batch does not pay for thread creation.
+     * - The calling thread takes part in the work as thread 0, so a pool with one thread
+     *   runs the tasks serially without any synchronization.
+     * - Tasks are handed out dynamically, so a task should write its result into a slot
+     *   indexed by the task (not by the thread) for the result to be independent of the
+     *   number of threads and of the scheduling.
+     */
+    class ThreadPool
+    {
+    public:
+        /**
+         *@brief Function that runs task <tt>task</tt> on thread <tt>thread</tt>.
+         */
+        typedef std::function<void(const int task, const int thread)> TaskFn;
+
+        ThreadPool(void);
+
+        virtual ~ThreadPool(void);
+
+        /**
+         *@brief Return the number of threads, including the calling thread.
+         */
+        virtual int GetNrThreads(void) const
+        {
+            return 1 + m_workers.size();
+        }
+
+        /**
+         *@brief Set the number of threads, including the calling thread.
+         *
+         *@remarks
+         * - It should not be called while a batch is running.
+         */
+        virtual void SetNrThreads(const int nrThreads);
+
+        /**
+         *@brief Run the tasks <tt>0, ..., nrTasks - 1</tt> and return when all of them are done.
+         */
+        virtual void Run(const int nrTasks, const TaskFn & fn);
+
+    protected:
+        virtual void StopWorkers(void);
+
+        virtual void WorkerLoop(const int thread);
+
+        virtual void RunTasks(const int thread);
+
+        std::vector<std::thread> m_workers;
+        std::mutex               m_mutex;
+        std::condition_variable  m_start;
+        std::condition_variable  m_done;
+        const TaskFn            *m_fn;
+        int                      m_nrTasks;
+        std::atomic<int>         m_nextTask;
+        int                      m_nrBusy;
+        unsigned long            m_batch;
+        bool                     m_stop;
+    };
+}
+
+#endif